@@ -26,7 +26,8 @@ public class Minesweeper : ModuleRules
             "ToolMenus",     // toolbar/menu
             "LevelEditor",   // Level Editor toolbar extension
             "Projects",
-            "EditorStyle"
+            "EditorStyle",
+            "Json"           // benchmark reports
             }
 		);
 	}
@@ -0,0 +1,101 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "MinesweeperBitBoard.h"
+
+namespace
+{
+    // Neighbour at X - 1 moved into bit X, pulling bit 63 of the previous word across the boundary
+    FORCEINLINE uint64 ShiftFromLeft(uint64 Prev, uint64 Cur)
+    {
+        return (Cur << 1) | (Prev >> 63);
+    }
+
+    // Neighbour at X + 1 moved into bit X, pulling bit 0 of the next word across the boundary
+    FORCEINLINE uint64 ShiftFromRight(uint64 Cur, uint64 Next)
+    {
+        return (Cur >> 1) | (Next << 63);
+    }
+
+    // Bit-sliced full adder: 64 independent 1-bit additions at once
+    FORCEINLINE void FullAdd(uint64 A, uint64 B, uint64 C, uint64& OutSum, uint64& OutCarry)
+    {
+        const uint64 AxB = A ^ B;
+        OutSum = AxB ^ C;
+        OutCarry = (A & B) | (C & AxB);
+    }
+
+}
+
+// Resizes the board and clears it
+void FMinesweeperBitBoard::Init(int32 InW, int32 InH)
+{
+    Width = FMath::Max(1, InW);
+    Height = FMath::Max(1, InH);
+    WordsPerRow = (Width + 63) / 64;
+
+    Bombs.SetNumZeroed(WordsPerRow * Height);
+    ZeroRow.SetNumZeroed(WordsPerRow);
+}
+
+// Bit-sliced neighbour count for the 64 tiles of Mid[1]; index 0/2 of each row are the words to its left/right
+void FMinesweeperBitBoard::CountNeighbours(const uint64 Up[3], const uint64 Mid[3], const uint64 Down[3], uint64 OutPlanes[4])
+{
+    // Up and down rows contribute three neighbours each, the middle row two
+    uint64 U0, U1, D0, D1;
+    FullAdd(ShiftFromLeft(Up[0], Up[1]), Up[1], ShiftFromRight(Up[1], Up[2]), U0, U1);
+    FullAdd(ShiftFromLeft(Down[0], Down[1]), Down[1], ShiftFromRight(Down[1], Down[2]), D0, D1);
+    const uint64 ML = ShiftFromLeft(Mid[0], Mid[1]);
+    const uint64 MR = ShiftFromRight(Mid[1], Mid[2]);
+    const uint64 M0 = ML ^ MR;
+    const uint64 M1 = ML & MR;
+
+    // Add the three 2-bit partial sums into a 4-bit count (0..8)
+    uint64 S0, K1;
+    FullAdd(U0, D0, M0, S0, K1);
+    uint64 T1, K2;
+    FullAdd(U1, D1, M1, T1, K2);
+    const uint64 K2b = T1 & K1;
+
+    OutPlanes[0] = S0;
+    OutPlanes[1] = T1 ^ K1;
+    OutPlanes[2] = K2 ^ K2b;
+    OutPlanes[3] = K2 & K2b;
+}
+
+// Sums the eight shifted neighbour rows of every tile with bitwise adders, one word (64 tiles) at a time
+void FMinesweeperBitBoard::CountAdjacencyRow(int32 Y, uint64* OutPlanes) const
+{
+    const uint64* Up = Y > 0 ? GetBombRow(Y - 1) : ZeroRow.GetData();
+    const uint64* Mid = GetBombRow(Y);
+    const uint64* Down = Y + 1 < Height ? GetBombRow(Y + 1) : ZeroRow.GetData();
+
+    for (int32 w = 0; w < WordsPerRow; ++w)
+    {
+        const bool bHasPrev = w > 0;
+        const bool bHasNext = w + 1 < WordsPerRow;
+        const uint64 UpWords[3] = { bHasPrev ? Up[w - 1] : 0, Up[w], bHasNext ? Up[w + 1] : 0 };
+        const uint64 MidWords[3] = { bHasPrev ? Mid[w - 1] : 0, Mid[w], bHasNext ? Mid[w + 1] : 0 };
+        const uint64 DownWords[3] = { bHasPrev ? Down[w - 1] : 0, Down[w], bHasNext ? Down[w + 1] : 0 };
+
+        uint64 Planes[4];
+        CountNeighbours(UpWords, MidWords, DownWords, Planes);
+        for (int32 p = 0; p < 4; ++p)
+        {
+            OutPlanes[p * WordsPerRow + w] = Planes[p];
+        }
+    }
+}
+
+// Bomb words go straight through the archive; a load of the wrong size errors and leaves the board cleared
+void FMinesweeperBitBoard::SerializeBombs(FArchive& Ar)
+{
+    const int32 ExpectedWords = Bombs.Num();
+    Bombs.BulkSerialize(Ar);
+    if (Ar.IsLoading() && Bombs.Num() != ExpectedWords)
+    {
+        Ar.SetError();
+        Bombs.Reset();
+        Bombs.SetNumZeroed(ExpectedWords);
+    }
+}
@@ -0,0 +1,405 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "MinesweeperChunkedBoard.h"
+#include "MinesweeperBitBoard.h"
+#include "MinesweeperStats.h"
+
+DECLARE_CYCLE_STAT(TEXT("Endless click"), STAT_MinesweeperEndlessClick, STATGROUP_Minesweeper);
+DECLARE_CYCLE_STAT(TEXT("Endless paging"), STAT_MinesweeperEndlessPaging, STATGROUP_Minesweeper);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Endless chunks resident"), STAT_MinesweeperEndlessChunks, STATGROUP_Minesweeper);
+
+namespace
+{
+    // Mixes the game seed and a chunk coordinate into a well-spread stream seed (murmur3 finalizer)
+    int32 ChunkSeed(int32 Seed, FIntPoint ChunkCoord)
+    {
+        uint32 H = uint32(Seed) ^ (uint32(ChunkCoord.X) * 0x9E3779B1u) ^ (uint32(ChunkCoord.Y) * 0x85EBCA77u);
+        H ^= H >> 16;
+        H *= 0x85EBCA6Bu;
+        H ^= H >> 13;
+        H *= 0xC2B2AE35u;
+        H ^= H >> 16;
+        return int32(H);
+    }
+}
+
+bool FMinesweeperChunkedBoard::FChunkMarks::IsEmpty() const
+{
+    uint64 Any = 0;
+    for (int32 y = 0; y < ChunkSize; ++y)
+    {
+        Any |= Revealed[y] | Flagged[y];
+    }
+    return Any == 0;
+}
+
+// Starts a new endless game; chunks are only generated when first touched
+void FMinesweeperChunkedBoard::NewGame(int32 InBombsPerChunk, int32 RandomSeed)
+{
+    BombsPerChunk = FMath::Clamp(InBombsPerChunk, 0, ChunkSize * ChunkSize - 9);
+    Seed = RandomSeed == 0 ? int32(FPlatformTime::Cycles() | 1) : RandomSeed;
+
+    Chunks.Empty();
+    PagedOut.Empty();
+    CachedCoord = FIntPoint(MAX_int32, MAX_int32);
+    CachedChunk = nullptr;
+    SafeTile = FIntPoint::ZeroValue;
+    TilesRevealed = 0;
+    FlagsPlaced = 0;
+    bStarted = false;
+    bGameOver = false;
+}
+
+// Partial Fisher-Yates over the chunk's tiles with a stream seeded from (seed, chunk coordinate).
+// The first click's tile and neighbours are then cleared; their bombs are not moved, so a chunk there has a few fewer.
+void FMinesweeperChunkedBoard::GenerateBombs(FIntPoint ChunkCoord, uint64 OutRows[ChunkSize]) const
+{
+    FMemory::Memzero(OutRows, sizeof(uint64) * ChunkSize);
+
+    FRandomStream Rng(ChunkSeed(Seed, ChunkCoord));
+    uint16 Indices[ChunkSize * ChunkSize];
+    for (int32 i = 0; i < ChunkSize * ChunkSize; ++i) Indices[i] = uint16(i);
+    for (int32 i = 0; i < BombsPerChunk; ++i)
+    {
+        const int32 Pick = Rng.RandRange(i, ChunkSize * ChunkSize - 1);
+        Swap(Indices[i], Indices[Pick]);
+        OutRows[Indices[i] >> ChunkShift] |= uint64(1) << (Indices[i] & (ChunkSize - 1));
+    }
+
+    if (!bStarted) return;
+    for (int32 dy = -1; dy <= 1; ++dy)
+    {
+        for (int32 dx = -1; dx <= 1; ++dx)
+        {
+            const int32 X = SafeTile.X + dx;
+            const int32 Y = SafeTile.Y + dy;
+            if (ToChunkCoord(X, Y) != ChunkCoord) continue;
+            OutRows[Y & (ChunkSize - 1)] &= ~(uint64(1) << (X & (ChunkSize - 1)));
+        }
+    }
+}
+
+// Bombs of the chunk itself, adjacency counted against the 3x3 chunk neighbourhood
+void FMinesweeperChunkedBoard::GenerateChunk(FIntPoint ChunkCoord, FChunk& OutChunk) const
+{
+    // Neighbour bombs are regenerated into scratch rows rather than materialising the neighbour chunks
+    uint64 Block[3][3][ChunkSize];
+    for (int32 dy = -1; dy <= 1; ++dy)
+    {
+        for (int32 dx = -1; dx <= 1; ++dx)
+        {
+            GenerateBombs(ChunkCoord + FIntPoint(dx, dy), Block[dy + 1][dx + 1]);
+        }
+    }
+    FMemory::Memcpy(OutChunk.Bombs, Block[1][1], sizeof(OutChunk.Bombs));
+
+    for (int32 y = 0; y < ChunkSize; ++y)
+    {
+        // Row y - 1 and y + 1 may come from the chunk above or below
+        const int32 UpBand = y == 0 ? 0 : 1;
+        const int32 UpRow = y == 0 ? ChunkSize - 1 : y - 1;
+        const int32 DownBand = y == ChunkSize - 1 ? 2 : 1;
+        const int32 DownRow = y == ChunkSize - 1 ? 0 : y + 1;
+
+        const uint64 Up[3] = { Block[UpBand][0][UpRow], Block[UpBand][1][UpRow], Block[UpBand][2][UpRow] };
+        const uint64 Mid[3] = { Block[1][0][y], Block[1][1][y], Block[1][2][y] };
+        const uint64 Down[3] = { Block[DownBand][0][DownRow], Block[DownBand][1][DownRow], Block[DownBand][2][DownRow] };
+
+        uint64 Planes[4];
+        FMinesweeperBitBoard::CountNeighbours(Up, Mid, Down, Planes);
+        for (int32 p = 0; p < 4; ++p)
+        {
+            OutChunk.Adjacency[p][y] = Planes[p];
+        }
+    }
+}
+
+// Finds or creates a chunk; a chunk coming back from being paged out gets its marks back
+FMinesweeperChunkedBoard::FChunk& FMinesweeperChunkedBoard::TouchChunk(FIntPoint ChunkCoord)
+{
+    if (CachedChunk && CachedCoord == ChunkCoord) return *CachedChunk;
+
+    TUniquePtr<FChunk>& Slot = Chunks.FindOrAdd(ChunkCoord);
+    if (!Slot.IsValid())
+    {
+        Slot = MakeUnique<FChunk>();
+        GenerateChunk(ChunkCoord, *Slot);
+
+        if (const TUniquePtr<FChunkMarks>* Marks = PagedOut.Find(ChunkCoord))
+        {
+            Slot->Marks = **Marks;
+            PagedOut.Remove(ChunkCoord);
+        }
+        else
+        {
+            FMemory::Memzero(Slot->Marks);
+        }
+    }
+
+    CachedCoord = ChunkCoord;
+    CachedChunk = Slot.Get();
+    return *CachedChunk;
+}
+
+FMinesweeperChunkedBoard::FChunk& FMinesweeperChunkedBoard::TouchTile(int32 X, int32 Y, int32& OutLocalX, int32& OutLocalY)
+{
+    OutLocalX = X & (ChunkSize - 1);
+    OutLocalY = Y & (ChunkSize - 1);
+    return TouchChunk(ToChunkCoord(X, Y));
+}
+
+bool FMinesweeperChunkedBoard::IsBomb(int32 X, int32 Y)
+{
+    int32 LX, LY;
+    const FChunk& C = TouchTile(X, Y, LX, LY);
+    return (C.Bombs[LY] >> LX) & 1;
+}
+
+bool FMinesweeperChunkedBoard::IsRevealed(int32 X, int32 Y)
+{
+    int32 LX, LY;
+    const FChunk& C = TouchTile(X, Y, LX, LY);
+    return (C.Marks.Revealed[LY] >> LX) & 1;
+}
+
+bool FMinesweeperChunkedBoard::IsFlagged(int32 X, int32 Y)
+{
+    int32 LX, LY;
+    const FChunk& C = TouchTile(X, Y, LX, LY);
+    return (C.Marks.Flagged[LY] >> LX) & 1;
+}
+
+int32 FMinesweeperChunkedBoard::GetAdjacent(int32 X, int32 Y)
+{
+    int32 LX, LY;
+    const FChunk& C = TouchTile(X, Y, LX, LY);
+    return int32((C.Adjacency[0][LY] >> LX) & 1)
+        | (int32((C.Adjacency[1][LY] >> LX) & 1) << 1)
+        | (int32((C.Adjacency[2][LY] >> LX) & 1) << 2)
+        | (int32((C.Adjacency[3][LY] >> LX) & 1) << 3);
+}
+
+// Reads a tile without creating its chunk
+FMSPTile FMinesweeperChunkedBoard::Get(int32 X, int32 Y) const
+{
+    FMSPTile T;
+    const TUniquePtr<FChunk>* Found = Chunks.Find(ToChunkCoord(X, Y));
+    if (!Found) return T;
+
+    const FChunk& C = **Found;
+    const int32 LX = X & (ChunkSize - 1);
+    const int32 LY = Y & (ChunkSize - 1);
+    T.bIsBomb = uint8((C.Bombs[LY] >> LX) & 1);
+    T.bRevealed = uint8(((C.Marks.Revealed[LY] >> LX) & 1) | (bGameOver ? T.bIsBomb : 0));
+    T.bFlagged = uint8((C.Marks.Flagged[LY] >> LX) & 1);
+    if (!T.bIsBomb)
+    {
+        T.Adjacent = uint8(((C.Adjacency[0][LY] >> LX) & 1)
+            | (((C.Adjacency[1][LY] >> LX) & 1) << 1)
+            | (((C.Adjacency[2][LY] >> LX) & 1) << 2)
+            | (((C.Adjacency[3][LY] >> LX) & 1) << 3));
+    }
+    return T;
+}
+
+// Pages out first, so nothing in view is dropped and paged straight back in; the tile cache may point at a dropped chunk
+bool FMinesweeperChunkedBoard::PageTo(const FIntRect& Tiles)
+{
+    MINESWEEPER_SCOPE(Minesweeper_EndlessPaging, STAT_MinesweeperEndlessPaging);
+    if (Tiles.Max.X <= Tiles.Min.X || Tiles.Max.Y <= Tiles.Min.Y) return false;
+
+    const FIntPoint MinChunk = ToChunkCoord(Tiles.Min.X, Tiles.Min.Y);
+    const FIntPoint MaxChunk = ToChunkCoord(Tiles.Max.X - 1, Tiles.Max.Y - 1);
+
+    CachedCoord = FIntPoint(MAX_int32, MAX_int32);
+    CachedChunk = nullptr;
+    for (auto It = Chunks.CreateIterator(); It; ++It)
+    {
+        const FIntPoint Coord = It.Key();
+        if (Coord.X >= MinChunk.X - 1 && Coord.X <= MaxChunk.X + 1 && Coord.Y >= MinChunk.Y - 1 && Coord.Y <= MaxChunk.Y + 1) continue;
+
+        const FChunkMarks& Marks = It.Value()->Marks;
+        if (!Marks.IsEmpty())
+        {
+            PagedOut.Add(Coord, MakeUnique<FChunkMarks>(Marks));
+        }
+        It.RemoveCurrent();
+    }
+
+    bool bPagedIn = false;
+    for (int32 cy = MinChunk.Y; cy <= MaxChunk.Y; ++cy)
+    {
+        for (int32 cx = MinChunk.X; cx <= MaxChunk.X; ++cx)
+        {
+            const FIntPoint Coord(cx, cy);
+            if (Chunks.Contains(Coord) || !(bGameOver || PagedOut.Contains(Coord))) continue;
+            TouchChunk(Coord);
+            bPagedIn = true;
+        }
+    }
+    SET_DWORD_STAT(STAT_MinesweeperEndlessChunks, Chunks.Num());
+    return bPagedIn;
+}
+
+// Handles a tile click, updating game state and reporting whether a bomb was hit and which tiles changed
+void FMinesweeperChunkedBoard::Click(int32 X, int32 Y, bool& bOutHitBomb, TArray<FIntPoint>& OutChanged)
+{
+    MINESWEEPER_SCOPE(Minesweeper_EndlessClick, STAT_MinesweeperEndlessClick);
+    bOutHitBomb = false;
+    OutChanged.Reset();
+    if (bGameOver || !IsValid(X, Y) || IsRevealed(X, Y) || IsFlagged(X, Y)) return;
+
+    if (!bStarted)
+    {
+        // Chunks flagged before the first click were generated without its clearing, so they are generated again
+        SafeTile = FIntPoint(X, Y);
+        bStarted = true;
+        for (TPair<FIntPoint, TUniquePtr<FChunk>>& Pair : Chunks)
+        {
+            GenerateChunk(Pair.Key, *Pair.Value);
+        }
+    }
+
+    OpenTile(X, Y, bOutHitBomb, OutChanged);
+    bGameOver = bOutHitBomb;
+}
+
+void FMinesweeperChunkedBoard::ToggleFlag(int32 X, int32 Y, TArray<FIntPoint>& OutChanged)
+{
+    OutChanged.Reset();
+    if (bGameOver || !IsValid(X, Y)) return;
+
+    int32 LX, LY;
+    FChunk& C = TouchTile(X, Y, LX, LY);
+    const uint64 Mask = uint64(1) << LX;
+    if (C.Marks.Revealed[LY] & Mask) return;
+
+    C.Marks.Flagged[LY] ^= Mask;
+    FlagsPlaced += (C.Marks.Flagged[LY] & Mask) ? 1 : -1;
+    OutChanged.Add(FIntPoint(X, Y));
+}
+
+void FMinesweeperChunkedBoard::Chord(int32 X, int32 Y, bool& bOutHitBomb, TArray<FIntPoint>& OutChanged)
+{
+    MINESWEEPER_SCOPE(Minesweeper_EndlessClick, STAT_MinesweeperEndlessClick);
+    bOutHitBomb = false;
+    OutChanged.Reset();
+    if (bGameOver || !IsValid(X, Y) || !IsRevealed(X, Y)) return;
+
+    const int32 Adjacent = GetAdjacent(X, Y);
+    int32 Flags = 0;
+    for (int32 dy = -1; dy <= 1; ++dy)
+    {
+        for (int32 dx = -1; dx <= 1; ++dx)
+        {
+            Flags += (dx | dy) != 0 && IsFlagged(X + dx, Y + dy);
+        }
+    }
+    if (Adjacent == 0 || Flags != Adjacent) return;
+
+    for (int32 dy = -1; dy <= 1; ++dy)
+    {
+        for (int32 dx = -1; dx <= 1; ++dx)
+        {
+            if ((dx | dy) == 0 || IsRevealed(X + dx, Y + dy) || IsFlagged(X + dx, Y + dy)) continue;
+            bool bHit = false;
+            OpenTile(X + dx, Y + dy, bHit, OutChanged);
+            bOutHitBomb |= bHit;
+        }
+    }
+    bGameOver = bOutHitBomb;
+}
+
+void FMinesweeperChunkedBoard::OpenTile(int32 X, int32 Y, bool& bOutHitBomb, TArray<FIntPoint>& OutChanged)
+{
+    if (IsBomb(X, Y))
+    {
+        // The other bombs show through Get once the game is over; only the one that was hit changes here
+        bOutHitBomb = true;
+        Reveal(X, Y, OutChanged);
+    }
+    else if (GetAdjacent(X, Y) == 0)
+    {
+        FloodFillZeros(X, Y, OutChanged);
+    }
+    else
+    {
+        Reveal(X, Y, OutChanged);
+    }
+}
+
+bool FMinesweeperChunkedBoard::Reveal(int32 X, int32 Y, TArray<FIntPoint>& OutChanged)
+{
+    int32 LX, LY;
+    FChunk& C = TouchTile(X, Y, LX, LY);
+    const uint64 Mask = uint64(1) << LX;
+    if (C.Marks.Revealed[LY] & Mask) return false;
+    C.Marks.Revealed[LY] |= Mask;
+    if (C.Marks.Flagged[LY] & Mask)
+    {
+        C.Marks.Flagged[LY] &= ~Mask;
+        --FlagsPlaced;
+    }
+    TilesRevealed += (C.Bombs[LY] & Mask) ? 0 : 1;
+    OutChanged.Add(FIntPoint(X, Y));
+    return true;
+}
+
+// Same run-by-run fill as the dense board, but on world coordinates and with a reveal budget,
+// since a sparse enough endless board has zero regions with no edge
+void FMinesweeperChunkedBoard::FloodFillZeros(int32 StartX, int32 StartY, TArray<FIntPoint>& OutChanged)
+{
+    FloodStack.Reset();
+    FloodStack.Add(FIntPoint(StartX, StartY));
+    const int32 Budget = OutChanged.Num() + MaxCascadeTiles;
+
+    auto IsHiddenZero = [this](int32 X, int32 Y)
+    {
+        return !IsRevealed(X, Y) && GetAdjacent(X, Y) == 0;
+    };
+
+    while (FloodStack.Num() > 0 && OutChanged.Num() < Budget)
+    {
+        const FIntPoint Pending = FloodStack.Pop(EAllowShrinking::No);
+        if (IsRevealed(Pending.X, Pending.Y)) continue;
+
+        // Widen within the remaining budget
+        const int32 MaxRun = Budget - OutChanged.Num();
+        int32 Left = Pending.X;
+        int32 Right = Pending.X;
+        while (Right - Left < MaxRun && IsHiddenZero(Left - 1, Pending.Y)) --Left;
+        while (Right - Left < MaxRun && IsHiddenZero(Right + 1, Pending.Y)) ++Right;
+
+        // A run the budget cut short ends on a hidden zero, which stays hidden rather than showing as an open zero
+        // next to hidden tiles
+        for (int32 x = Left; x <= Right; ++x)
+        {
+            Reveal(x, Pending.Y, OutChanged);
+        }
+        if (!IsHiddenZero(Left - 1, Pending.Y)) Reveal(Left - 1, Pending.Y, OutChanged);
+        if (!IsHiddenZero(Right + 1, Pending.Y)) Reveal(Right + 1, Pending.Y, OutChanged);
+
+        for (int32 ny = Pending.Y - 1; ny <= Pending.Y + 1; ny += 2)
+        {
+            bool bInZeroRun = false;
+            for (int32 x = Left - 1; x <= Right + 1; ++x)
+            {
+                if (IsRevealed(x, ny))
+                {
+                    bInZeroRun = false;
+                }
+                else if (GetAdjacent(x, ny) == 0)
+                {
+                    if (!bInZeroRun) FloodStack.Add(FIntPoint(x, ny));
+                    bInZeroRun = true;
+                }
+                else
+                {
+                    Reveal(x, ny, OutChanged);
+                    bInZeroRun = false;
+                }
+            }
+        }
+    }
+}
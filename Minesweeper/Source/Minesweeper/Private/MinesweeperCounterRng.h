@@ -0,0 +1,44 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+// Counter-based random numbers (Philox4x32-10, Salmon et al. 2011): the output for a counter is a pure function
+// of the counter and the key, so any element of a sequence can be drawn directly, in any order, on any thread.
+namespace MinesweeperCounterRng
+{
+    // Four 32-bit words for Counter under Key
+    inline void Philox4x32(const uint32 Counter[4], const uint32 Key[2], uint32 Out[4])
+    {
+        uint32 C0 = Counter[0], C1 = Counter[1], C2 = Counter[2], C3 = Counter[3];
+        uint32 K0 = Key[0], K1 = Key[1];
+        for (int32 Round = 0; Round < 10; ++Round)
+        {
+            const uint64 P0 = uint64(0xD2511F53u) * C0;
+            const uint64 P1 = uint64(0xCD9E8D57u) * C2;
+            const uint32 Hi0 = uint32(P0 >> 32), Lo0 = uint32(P0);
+            const uint32 Hi1 = uint32(P1 >> 32), Lo1 = uint32(P1);
+            C0 = Hi1 ^ C1 ^ K0;
+            C1 = Lo1;
+            C2 = Hi0 ^ C3 ^ K1;
+            C3 = Lo0;
+            K0 += 0x9E3779B9u;
+            K1 += 0xBB67AE85u;
+        }
+        Out[0] = C0;
+        Out[1] = C1;
+        Out[2] = C2;
+        Out[3] = C3;
+    }
+
+    // Random 64-bit key of board tile Index for a seed; Stream keeps different uses of one seed apart
+    inline uint64 TileKey(int32 Seed, int32 Index, uint32 Stream = 0)
+    {
+        const uint32 Counter[4] = { uint32(Index), Stream, 0, 0 };
+        const uint32 Key[2] = { uint32(Seed), 0x6D696E65u };
+        uint32 Out[4];
+        Philox4x32(Counter, Key, Out);
+        return (uint64(Out[0]) << 32) | Out[1];
+    }
+}
@@ -2,22 +2,372 @@
 
 
 #include "MinesweeperGameLogic.h"
-#include "Containers/Queue.h"
+#include "MinesweeperSolver.h"
+#include "MinesweeperFixedBoard.h"
+#include "MinesweeperVarInt.h"
+#include "MinesweeperCounterRng.h"
+#include "MinesweeperStats.h"
+#include "Async/ParallelFor.h"
+#include "Algo/BinarySearch.h"
+#include "Misc/ScopeExit.h"
+#include "Async/TaskGraphInterfaces.h"
+#include <atomic>
 
-// Starts a new game with the given dimensions, number of bombs, and optional random seed
+DECLARE_CYCLE_STAT(TEXT("NewGame"), STAT_MinesweeperNewGame, STATGROUP_Minesweeper);
+DECLARE_CYCLE_STAT(TEXT("NewGameNoGuess"), STAT_MinesweeperNewGameNoGuess, STATGROUP_Minesweeper);
+DECLARE_CYCLE_STAT(TEXT("Serialize"), STAT_MinesweeperSerialize, STATGROUP_Minesweeper);
+DECLARE_CYCLE_STAT(TEXT("PlaceBombs"), STAT_MinesweeperPlaceBombs, STATGROUP_Minesweeper);
+DECLARE_CYCLE_STAT(TEXT("ComputeAdjacency"), STAT_MinesweeperComputeAdjacency, STATGROUP_Minesweeper);
+DECLARE_CYCLE_STAT(TEXT("Click"), STAT_MinesweeperClick, STATGROUP_Minesweeper);
+DECLARE_CYCLE_STAT(TEXT("FloodFillZeros"), STAT_MinesweeperFloodFillZeros, STATGROUP_Minesweeper);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Tiles revealed (last click)"), STAT_MinesweeperTilesRevealedLastClick, STATGROUP_Minesweeper);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Tiles revealed (this frame)"), STAT_MinesweeperTilesRevealed, STATGROUP_Minesweeper);
+
+namespace
+{
+    // How the revealed plane is stored in a save
+    enum class ERevealedEncoding : uint8
+    {
+        Bitmap,
+        RunLength
+    };
+
+    // Plays a fresh candidate from its first click using only solver deductions; true if every safe tile gets revealed.
+    // Gives up once bFound is set or the solver's cancel flag is.
+    bool IsSolvableWithoutGuessing(FMinesweeperGameLogic& Candidate, FMinesweeperSolver& Solver, int32 StartX, int32 StartY,
+        TArray<int32>& Changed, const std::atomic<bool>& bFound)
+    {
+        // Bombs are placed by this first click and kept off the start tile's neighbourhood, so it always opens a region
+        Solver.Reset(Candidate);
+        bool bHitBomb = false;
+        Candidate.Click(StartX, StartY, bHitBomb, Changed);
+        Solver.OnTilesChanged(Changed);
+
+        while (!Candidate.IsGameOver())
+        {
+            if (bFound.load(std::memory_order_relaxed) || Solver.IsCancelled()) return false;
+
+            Solver.Solve();
+            if (Solver.IsCancelled()) return false;
+            int32 Next = INDEX_NONE;
+            if (!Solver.PopSafeTile(Next)) return false; // would need a guess
+
+            Candidate.Click(Next % Candidate.GetWidth(), Next / Candidate.GetWidth(), bHitBomb, Changed);
+            if (bHitBomb) return false;
+            Solver.OnTilesChanged(Changed);
+        }
+        return Candidate.IsWon();
+    }
+}
+
+// Starts a new game with the given dimensions, number of bombs, and optional random seed.
+// The board starts empty; bombs are placed on the first click so that click is always safe.
 void FMinesweeperGameLogic::NewGame(int32 InW, int32 InH, int32 InBombs, int32 RandomSeed)
 {
-    Width = FMath::Max(1, InW);
-    Height = FMath::Max(1, InH);
-    const int32 MaxBombs = FMath::Clamp(InBombs, 0, Width * Height - 1);
+    MINESWEEPER_SCOPE(Minesweeper_NewGame, STAT_MinesweeperNewGame);
+    Topology.Build(InW, InH);
+    Width = Topology.GetWidth();
+    Height = Topology.GetHeight();
+    NumBombs = FMath::Clamp(InBombs, 0, Width * Height - 1);
 
-    Grid.Empty();
-    Grid.SetNum(Width * Height);
+    InitGrid();
+    Bits.Init(Width, Height);
+    BombIndices.Reset();
+    SafeTilesLeft = Width * Height - NumBombs;
+    FlagsPlaced = 0;
     bGameOver = false;
+    bWon = false;
+    bBombsPlaced = false;
+    ResetJournal();
+
+    // Never store 0 as the seed, since passing 0 back in means "seed from the clock"
+    Seed = RandomSeed == 0 ? int32(FPlatformTime::Cycles() | 1) : RandomSeed;
+}
+
+// Places the bombs from the stored seed, keeping (SafeX, SafeY) and its neighbours clear; no-op once placed
+void FMinesweeperGameLogic::PlaceBombsAround(int32 SafeX, int32 SafeY)
+{
+    if (bBombsPlaced || !IsValid(SafeX, SafeY)) return;
+
+    if (Generator == EMinesweeperGenerator::Counter)
+    {
+        PlaceBombsCounter(NumBombs, SafeX, SafeY);
+    }
+    else
+    {
+        FRandomStream Rng(Seed);
+        PlaceBombs(NumBombs, SafeX, SafeY, Rng);
+    }
+    ComputeAdjacency();
+    bBombsPlaced = true;
+}
+
+// The layout stands in for placement, so the first click is not kept clear
+bool FMinesweeperGameLogic::NewGameWithBombs(int32 InW, int32 InH, TArrayView<const int32> InBombIndices)
+{
+    NewGame(InW, InH, InBombIndices.Num(), 1);
+    if (NumBombs != InBombIndices.Num())
+    {
+        NewGame(InW, InH, 0, 1);
+        return false;
+    }
 
-    FRandomStream Rng(RandomSeed == 0 ? FPlatformTime::Cycles() : RandomSeed);
-    PlaceBombs(MaxBombs, Rng);
+    BombIndices.Reserve(NumBombs);
+    for (const int32 Index : InBombIndices)
+    {
+        if (Index < 0 || Index >= Width * Height || Bits.IsBomb(Index % Width, Index / Width))
+        {
+            NewGame(InW, InH, 0, 1);
+            return false;
+        }
+        Bits.SetBomb(Index % Width, Index / Width, true);
+        BombIndices.Add(Index);
+    }
     ComputeAdjacency();
+    bBombsPlaced = true;
+    return true;
+}
+
+// Generates candidate boards on every worker until one is solvable from the start tile without guessing
+FMinesweeperNoGuessStats FMinesweeperGameLogic::NewGameNoGuess(int32 InW, int32 InH, int32 InBombs, int32 StartX, int32 StartY, double MaxSeconds, int32 RandomSeed,
+    FMinesweeperGenerationControl* Control)
+{
+    MINESWEEPER_SCOPE(Minesweeper_NewGameNoGuess, STAT_MinesweeperNewGameNoGuess);
+    const double StartTime = FPlatformTime::Seconds();
+    const int32 W = Topology.HasFixedSize() ? Topology.GetWidth() : FMath::Max(1, InW);
+    const int32 H = Topology.HasFixedSize() ? Topology.GetHeight() : FMath::Max(1, InH);
+    const int32 MaxBombs = FMath::Clamp(InBombs, 0, W * H - 1);
+    StartX = FMath::Clamp(StartX, 0, W - 1);
+    StartY = FMath::Clamp(StartY, 0, H - 1);
+
+    // Candidate seeds are a fixed sequence, so a given attempt always produces the same layout
+    const uint32 BaseSeed = RandomSeed == 0 ? FPlatformTime::Cycles() : uint32(RandomSeed);
+    auto CandidateSeed = [BaseSeed](int32 Attempt)
+    {
+        const int32 Seed = int32(BaseSeed + uint32(Attempt) * 2654435761u);
+        return Seed == 0 ? 1 : Seed; // zero would mean "seed from the clock"
+    };
+
+    std::atomic<int32> NextAttempt { 0 };
+    std::atomic<int32> WinningAttempt { INDEX_NONE };
+    std::atomic<bool> bFound { false };
+
+    // One long-lived search loop per worker, each reusing its own candidate game, solver and scratch
+    const int32 NumWorkers = FMath::Max(1, FTaskGraphInterface::Get().GetNumWorkerThreads());
+    ParallelFor(NumWorkers, [&](int32)
+    {
+        FMinesweeperGameLogic Candidate;
+        Candidate.SetUndoEnabled(false);
+        Candidate.SetTopology(Topology);
+        Candidate.SetGenerator(Generator);
+        // The solver also watches the cancel flag, so a large candidate stops mid-solve
+        FMinesweeperSolver Solver;
+        Solver.SetCancelFlag(Control ? &Control->bCancel : nullptr);
+        TArray<int32> Changed;
+
+        while (!bFound.load(std::memory_order_relaxed) && FPlatformTime::Seconds() - StartTime < MaxSeconds && !Solver.IsCancelled())
+        {
+            const int32 Attempt = NextAttempt.fetch_add(1, std::memory_order_relaxed);
+            if (Control) Control->Attempts.fetch_add(1, std::memory_order_relaxed);
+            Candidate.NewGame(W, H, MaxBombs, CandidateSeed(Attempt));
+            if (IsSolvableWithoutGuessing(Candidate, Solver, StartX, StartY, Changed, bFound))
+            {
+                bool bExpected = false;
+                if (bFound.compare_exchange_strong(bExpected, true))
+                {
+                    WinningAttempt.store(Attempt);
+                }
+            }
+        }
+    });
+
+    FMinesweeperNoGuessStats Stats;
+    Stats.Attempts = NextAttempt.load();
+    Stats.bSucceeded = bFound.load();
+    Stats.Seed = CandidateSeed(Stats.bSucceeded ? WinningAttempt.load() : 0);
+
+    // Generation is deterministic per seed and start tile, so rebuilding the winner is cheaper than copying it out of a worker.
+    // A winning layout is placed now so it survives a first click elsewhere; a fallback board stays deferred.
+    NewGame(W, H, MaxBombs, Stats.Seed);
+    if (Stats.bSucceeded)
+    {
+        PlaceBombsAround(StartX, StartY);
+    }
+    Stats.Seconds = FPlatformTime::Seconds() - StartTime;
+    return Stats;
+}
+
+// Saves or loads the game; loading rebuilds adjacency from the bomb plane instead of reading it.
+// Only the current layout loads; a save from another version fails and the caller starts a new game.
+void FMinesweeperGameLogic::Serialize(FArchive& Ar)
+{
+    MINESWEEPER_SCOPE(Minesweeper_Serialize, STAT_MinesweeperSerialize);
+    int32 Version = SaveVersion;
+    Ar << Version;
+    if (Ar.IsLoading() && Version != SaveVersion)
+    {
+        Ar.SetError();
+        return;
+    }
+
+    int32 SavedWidth = Width, SavedHeight = Height, SavedBombs = NumBombs, SavedSeed = Seed;
+    bool bSavedGameOver = bGameOver;
+    Ar << SavedWidth << SavedHeight << SavedBombs << SavedSeed << bSavedGameOver;
+
+    bool bSavedBombsPlaced = bBombsPlaced;
+    Ar << bSavedBombsPlaced;
+
+    Topology.Serialize(Ar);
+    if (Ar.IsError()) return;
+
+    // A game saved before its first click still needs its generator to place the bombs
+    uint8 SavedGenerator = uint8(Generator);
+    Ar << SavedGenerator;
+    if (SavedGenerator > uint8(EMinesweeperGenerator::Counter))
+    {
+        Ar.SetError();
+        return;
+    }
+
+    if (Ar.IsLoading())
+    {
+        if (SavedWidth < 1 || SavedHeight < 1 || int64(SavedWidth) * SavedHeight > MAX_int32
+            || SavedBombs < 0 || SavedBombs >= SavedWidth * SavedHeight
+            || (Topology.HasFixedSize() && (Topology.GetWidth() != SavedWidth || Topology.GetHeight() != SavedHeight)))
+        {
+            Ar.SetError();
+            return;
+        }
+
+        Width = SavedWidth;
+        Height = SavedHeight;
+        NumBombs = SavedBombs;
+        Seed = SavedSeed;
+        bGameOver = bSavedGameOver;
+        bBombsPlaced = bSavedBombsPlaced;
+        Generator = EMinesweeperGenerator(SavedGenerator);
+        Topology.Build(Width, Height);
+        InitGrid();
+        Bits.Init(Width, Height);
+    }
+
+    Bits.SerializeBombs(Ar);
+
+    // Flags live in the tiles during play and are saved as bit rows laid out like the bomb plane
+    const int32 FlagWordsPerRow = Bits.GetWordsPerRow();
+    TArray<uint64> FlagWords;
+    if (Ar.IsSaving())
+    {
+        FlagWords.SetNumZeroed(FlagWordsPerRow * Height);
+        for (int32 i = 0; i < Width * Height; ++i)
+        {
+            const int32 X = i % Width;
+            FlagWords[(i / Width) * FlagWordsPerRow + (X >> 6)] |= uint64(GetByIndex(i).bFlagged) << (X & 63);
+        }
+    }
+    FlagWords.BulkSerialize(Ar);
+    if (Ar.IsError() || FlagWords.Num() != FlagWordsPerRow * Height)
+    {
+        Ar.SetError();
+        return;
+    }
+
+    TArray<uint8> Revealed;
+    uint8 Encoding = Ar.IsSaving() ? EncodeRevealed(Revealed) : 0;
+    Ar << Encoding;
+    Revealed.BulkSerialize(Ar);
+
+    if (Ar.IsLoading())
+    {
+        CollectBombIndices();
+        ComputeAdjacency();
+        if (Ar.IsError() || !DecodeRevealed(Revealed, Encoding) || BombIndices.Num() != (bBombsPlaced ? NumBombs : 0))
+        {
+            Ar.SetError();
+            return;
+        }
+
+        // Counters are derived state, rebuilt rather than saved
+        SafeTilesLeft = Width * Height - NumBombs;
+        FlagsPlaced = 0;
+        for (int32 i = 0; i < Width * Height; ++i)
+        {
+            FMSPTile& T = TileAt(i);
+            const int32 X = i % Width;
+            T.bFlagged = uint8((FlagWords[(i / Width) * FlagWordsPerRow + (X >> 6)] >> (X & 63)) & 1);
+            SafeTilesLeft -= (T.bRevealed && !T.bIsBomb) ? 1 : 0;
+            FlagsPlaced += T.bFlagged;
+        }
+        bWon = bGameOver && SafeTilesLeft == 0;
+        ResetJournal();
+    }
+}
+
+// Run lengths alternate hidden/revealed starting with hidden; falls back to a bitmap when runs would be larger
+uint8 FMinesweeperGameLogic::EncodeRevealed(TArray<uint8>& Out) const
+{
+    const int32 NumTiles = Width * Height;
+    const int32 BitmapBytes = (NumTiles + 7) / 8;
+
+    Out.Reset();
+    bool bState = false;
+    int32 RunStart = 0;
+    for (int32 i = 0; i <= NumTiles && Out.Num() < BitmapBytes; ++i)
+    {
+        if (i == NumTiles || GetByIndex(i).bRevealed != bState)
+        {
+            MinesweeperVarInt::WriteUInt(Out, uint32(i - RunStart));
+            RunStart = i;
+            bState = !bState;
+        }
+    }
+    if (Out.Num() < BitmapBytes)
+    {
+        return uint8(ERevealedEncoding::RunLength);
+    }
+
+    Out.Reset();
+    Out.SetNumZeroed(BitmapBytes);
+    for (int32 i = 0; i < NumTiles; ++i)
+    {
+        Out[i >> 3] |= uint8(GetByIndex(i).bRevealed) << (i & 7);
+    }
+    return uint8(ERevealedEncoding::Bitmap);
+}
+
+bool FMinesweeperGameLogic::DecodeRevealed(TArrayView<const uint8> Data, uint8 Encoding)
+{
+    const int32 NumTiles = Width * Height;
+
+    if (Encoding == uint8(ERevealedEncoding::Bitmap))
+    {
+        if (Data.Num() != (NumTiles + 7) / 8) return false;
+        for (int32 i = 0; i < NumTiles; ++i)
+        {
+            TileAt(i).bRevealed = (Data[i >> 3] >> (i & 7)) & 1;
+        }
+        return true;
+    }
+
+    if (Encoding == uint8(ERevealedEncoding::RunLength))
+    {
+        int32 Pos = 0;
+        int32 Tile = 0;
+        bool bState = false;
+        while (Tile < NumTiles)
+        {
+            uint32 Run = 0;
+            if (!MinesweeperVarInt::ReadUInt(Data, Pos, Run) || Run > uint32(NumTiles - Tile)) return false;
+            for (const int32 End = Tile + int32(Run); Tile < End; ++Tile)
+            {
+                TileAt(Tile).bRevealed = bState;
+            }
+            bState = !bState;
+        }
+        return Pos == Data.Num();
+    }
+
+    return false;
 }
 
 // Checks whether the given coordinates are inside the grid bounds
@@ -26,115 +376,743 @@ bool FMinesweeperGameLogic::IsValid(int32 X, int32 Y) const
     return (X >= 0 && X < Width && Y >= 0 && Y < Height);
 }
 
-// Randomly places bombs on the grid using the provided RNG
-void FMinesweeperGameLogic::PlaceBombs(int32 Bombs, FRandomStream& Rng)
+// Border tiles are revealed non-bombs, so nothing ever opens them and fills stop at them
+void FMinesweeperGameLogic::InitGrid()
 {
-    TArray<int32> Indices;
-    Indices.Reserve(Width * Height);
-    for (int32 i = 0; i < Width * Height; ++i) Indices.Add(i);
-    for (int32 i = 0; i < Bombs; ++i)
+    const int32 Stride = Width + 2;
+    Grid.Reset();
+    Grid.SetNum(Stride * (Height + 2));
+    for (int32 x = 0; x < Stride; ++x)
+    {
+        Grid[x].bRevealed = true;
+        Grid[(Height + 1) * Stride + x].bRevealed = true;
+    }
+    for (int32 y = 1; y <= Height; ++y)
     {
-        const int32 Pick = Rng.RandRange(i, Indices.Num() - 1);
-        Indices.Swap(i, Pick);
-        Grid[Indices[i]].bIsBomb = true;
+        Grid[y * Stride].bRevealed = true;
+        Grid[y * Stride + Width + 1].bRevealed = true;
     }
+
+    // The sizes played most get kernels with the size baked in, on the square grid they are written for
+    FixedCountAdjacency = nullptr;
+    FixedFloodFill = nullptr;
+    if (Topology.GetKind() != EMinesweeperTopology::Square) return;
+
+    auto UseFixedBoard = [this](auto Board)
+    {
+        using FBoard = decltype(Board);
+        FixedCountAdjacency = &FBoard::CountAdjacency;
+        FixedFloodFill = &FBoard::FloodFill;
+    };
+    if (Width == 9 && Height == 9) UseFixedBoard(TMinesweeperBoard<9, 9>());
+    else if (Width == 16 && Height == 16) UseFixedBoard(TMinesweeperBoard<16, 16>());
+    else if (Width == 30 && Height == 16) UseFixedBoard(TMinesweeperBoard<30, 16>());
 }
 
-// Computes the number of adjacent bombs for each tile
-void FMinesweeperGameLogic::ComputeAdjacency()
+// Rows per generation band; sized from the tile count only so a seed gives the same board on any core count
+int32 FMinesweeperGameLogic::GetBandRows() const
 {
-    for (int32 y = 0; y < Height; ++y)
+    return FMath::Max(1, GenerationBandTiles / Width);
+}
+
+// The clicked tile and its neighbours; only the clicked tile itself when the board is too full for its neighbours
+void FMinesweeperGameLogic::GetExcludedTiles(int32 Bombs, int32 SafeX, int32 SafeY, FExcludedTiles& OutExcluded) const
+{
+    OutExcluded.Reset();
+    OutExcluded.Add(SafeY * Width + SafeX);
+    Topology.ForEachNeighbour(SafeY * Width + SafeX, [&OutExcluded](int32 N) { OutExcluded.Add(N); });
+    OutExcluded.Sort();
+    if (Bombs > Width * Height - OutExcluded.Num())
     {
-        for (int32 x = 0; x < Width; ++x)
+        OutExcluded.Reset();
+        OutExcluded.Add(SafeY * Width + SafeX);
+    }
+}
+
+// Randomly places bombs on the grid using the provided RNG, keeping them off (SafeX, SafeY) and its neighbours.
+// The bomb total is split across row bands up front, then each band samples its own tiles in parallel
+// with a stream seeded from Rng, so the result does not depend on how the bands are scheduled.
+// Each band uses Floyd's sampling over its allowed tiles with the bomb plane as the "already picked" set,
+// so the work scales with the bomb count and nothing the size of the board is allocated.
+void FMinesweeperGameLogic::PlaceBombs(int32 Bombs, int32 SafeX, int32 SafeY, FRandomStream& Rng)
+{
+    MINESWEEPER_SCOPE(Minesweeper_PlaceBombs, STAT_MinesweeperPlaceBombs);
+    BombIndices.Reset();
+    if (Bombs <= 0) return;
+
+    const int32 BandRows = GetBandRows();
+    const int32 NumBands = FMath::DivideAndRoundUp(Height, BandRows);
+
+    FExcludedTiles Excluded;
+    GetExcludedTiles(Bombs, SafeX, SafeY, Excluded);
+
+    // Allowed tiles per band
+    TArray<int32> BandFree;
+    BandFree.SetNumUninitialized(NumBands);
+    int64 TotalFree = 0;
+    for (int32 b = 0; b < NumBands; ++b)
+    {
+        const int32 FirstIndex = b * BandRows * Width;
+        const int32 NumTiles = FMath::Min(BandRows, Height - b * BandRows) * Width;
+        BandFree[b] = NumTiles;
+        for (const int32 Index : Excluded)
+        {
+            if (Index >= FirstIndex && Index < FirstIndex + NumTiles) --BandFree[b];
+        }
+        TotalFree += BandFree[b];
+    }
+
+    // Proportional share per band, rounded down
+    TArray<int32> BandBombs;
+    BandBombs.SetNumUninitialized(NumBands);
+    int32 Assigned = 0;
+    for (int32 b = 0; b < NumBands; ++b)
+    {
+        BandBombs[b] = int32(int64(Bombs) * BandFree[b] / TotalFree);
+        Assigned += BandBombs[b];
+    }
+
+    // The rounding remainder (fewer than NumBands bombs) goes to distinct random bands that still have room
+    TArray<int32> BandOrder;
+    BandOrder.SetNumUninitialized(NumBands);
+    for (int32 b = 0; b < NumBands; ++b) BandOrder[b] = b;
+    int32 Remaining = Bombs - Assigned;
+    for (int32 i = 0; i < NumBands && Remaining > 0; ++i)
+    {
+        const int32 Pick = Rng.RandRange(i, NumBands - 1);
+        BandOrder.Swap(i, Pick);
+        const int32 Band = BandOrder[i];
+        if (BandBombs[Band] < BandFree[Band])
         {
-            FMSPTile& T = Grid[y * Width + x];
-            if (!T.bIsBomb)
+            ++BandBombs[Band];
+            --Remaining;
+        }
+    }
+
+    TArray<int32> BandSeeds;
+    BandSeeds.SetNumUninitialized(NumBands);
+    for (int32 b = 0; b < NumBands; ++b) BandSeeds[b] = int32(Rng.GetUnsignedInt());
+
+    // Each band writes its bomb indices into its own slice of BombIndices
+    TArray<int32> BandOffsets;
+    BandOffsets.SetNumUninitialized(NumBands);
+    for (int32 b = 0, Offset = 0; b < NumBands; Offset += BandBombs[b], ++b) BandOffsets[b] = Offset;
+    BombIndices.SetNumUninitialized(Bombs);
+
+    // Bands cover whole rows, and bit rows never share a word, so bands write disjoint memory
+    ParallelFor(NumBands, [this, BandRows, &BandBombs, &BandFree, &BandSeeds, &BandOffsets, &Excluded](int32 Band)
+    {
+        const int32 FirstIndex = Band * BandRows * Width;
+
+        // The R-th allowed tile of the band, stepping over excluded tiles in order
+        auto AllowedTile = [FirstIndex, &Excluded](int32 R)
+        {
+            int32 Index = FirstIndex + R;
+            for (const int32 Skip : Excluded)
             {
-                T.Adjacent = CountAdj(x, y);
+                if (Skip >= FirstIndex && Skip <= Index) ++Index;
             }
+            return Index;
+        };
+
+        // Floyd: pick from [0, j]; if that tile is taken, j itself is always free
+        FRandomStream BandRng(BandSeeds[Band]);
+        const int32 Free = BandFree[Band];
+        int32* OutIndex = BombIndices.GetData() + BandOffsets[Band];
+        for (int32 j = Free - BandBombs[Band]; j < Free; ++j)
+        {
+            int32 Index = AllowedTile(BandRng.RandRange(0, j));
+            if (Bits.IsBomb(Index % Width, Index / Width))
+            {
+                Index = AllowedTile(j);
+            }
+            Bits.SetBomb(Index % Width, Index / Width, true);
+            *OutIndex++ = Index;
         }
+    });
+}
+
+// Keys every allowed tile from the seed and makes bombs of the Bombs smallest keys, ties going to the lower index,
+// so whether a tile is a bomb depends only on its own key and one cut shared by the whole board.
+// The cut is found by a radix select on the top key bits: a histogram pass, a sort of the one bucket the cut falls in,
+// then a pass marking every tile below it. Each pass works per row band and recomputes the keys rather than storing them,
+// so memory stays at one histogram per band and the result does not depend on how the bands are scheduled.
+void FMinesweeperGameLogic::PlaceBombsCounter(int32 Bombs, int32 SafeX, int32 SafeY)
+{
+    MINESWEEPER_SCOPE(Minesweeper_PlaceBombs, STAT_MinesweeperPlaceBombs);
+    BombIndices.Reset();
+    if (Bombs <= 0) return;
+
+    constexpr int32 BucketBits = 12;
+    constexpr int32 NumBuckets = 1 << BucketBits;
+    const int32 BandRows = GetBandRows();
+    const int32 NumBands = FMath::DivideAndRoundUp(Height, BandRows);
+
+    FExcludedTiles Excluded;
+    GetExcludedTiles(Bombs, SafeX, SafeY, Excluded);
+
+    // Calls Func(Index, Key) for every allowed tile of a band, in index order
+    auto ForEachKey = [this, BandRows, &Excluded](int32 Band, auto&& Func)
+    {
+        const int32 FirstIndex = Band * BandRows * Width;
+        const int32 EndIndex = FMath::Min(Height, (Band + 1) * BandRows) * Width;
+        int32 Skip = Algo::LowerBound(Excluded, FirstIndex);
+        for (int32 Index = FirstIndex; Index < EndIndex; ++Index)
+        {
+            if (Skip < Excluded.Num() && Excluded[Skip] == Index)
+            {
+                ++Skip;
+                continue;
+            }
+            Func(Index, MinesweeperCounterRng::TileKey(Seed, Index));
+        }
+    };
+
+    TArray<int32> Histograms;
+    Histograms.SetNumZeroed(NumBands * NumBuckets);
+    ParallelFor(NumBands, [&Histograms, &ForEachKey](int32 Band)
+    {
+        int32* Histogram = Histograms.GetData() + Band * NumBuckets;
+        ForEachKey(Band, [Histogram](int32, uint64 Key) { ++Histogram[Key >> (64 - BucketBits)]; });
+    });
+
+    // Bucket holding the Bombs-th smallest key, and how many bombs the buckets below it already hold
+    int32 CutBucket = 0;
+    int32 Below = 0;
+    for (; CutBucket < NumBuckets - 1; ++CutBucket)
+    {
+        int32 InBucket = 0;
+        for (int32 b = 0; b < NumBands; ++b) InBucket += Histograms[b * NumBuckets + CutBucket];
+        if (Below + InBucket >= Bombs) break;
+        Below += InBucket;
+    }
+
+    // Only that bucket needs sorting; it holds about 1 / NumBuckets of the board
+    struct FKeyedTile
+    {
+        uint64 Key;
+        int32 Index;
+        bool operator<(const FKeyedTile& Other) const { return Key < Other.Key || (Key == Other.Key && Index < Other.Index); }
+    };
+    TArray<TArray<FKeyedTile>> BandCandidates;
+    BandCandidates.SetNum(NumBands);
+    ParallelFor(NumBands, [&BandCandidates, &ForEachKey, CutBucket](int32 Band)
+    {
+        TArray<FKeyedTile>& Candidates = BandCandidates[Band];
+        ForEachKey(Band, [&Candidates, CutBucket](int32 Index, uint64 Key)
+        {
+            if (int32(Key >> (64 - BucketBits)) == CutBucket) Candidates.Add({ Key, Index });
+        });
+    });
+    TArray<FKeyedTile> Candidates;
+    for (const TArray<FKeyedTile>& Band : BandCandidates) Candidates.Append(Band);
+    Candidates.Sort();
+    const FKeyedTile Cut = Candidates[Bombs - Below - 1];
+
+    // Each band writes its bomb indices into its own slice of BombIndices, sized from its histogram and candidates
+    TArray<int32> BandOffsets;
+    BandOffsets.SetNumUninitialized(NumBands);
+    for (int32 b = 0, Offset = 0; b < NumBands; ++b)
+    {
+        BandOffsets[b] = Offset;
+        for (int32 Bucket = 0; Bucket < CutBucket; ++Bucket) Offset += Histograms[b * NumBuckets + Bucket];
+        for (const FKeyedTile& Candidate : BandCandidates[b]) Offset += !(Cut < Candidate);
+    }
+    BombIndices.SetNumUninitialized(Bombs);
+
+    // Bands cover whole rows, and bit rows never share a word, so bands write disjoint memory
+    ParallelFor(NumBands, [this, &ForEachKey, &BandOffsets, Cut](int32 Band)
+    {
+        int32* OutIndex = BombIndices.GetData() + BandOffsets[Band];
+        ForEachKey(Band, [this, &OutIndex, Cut](int32 Index, uint64 Key)
+        {
+            if (Cut < FKeyedTile{ Key, Index }) return;
+
+            Bits.SetBomb(Index % Width, Index / Width, true);
+            *OutIndex++ = Index;
+        });
+    });
+}
+
+// Computes the number of adjacent bombs for each tile a bit row at a time,
+// then unpacks bombs and counts into the grid, one row band per task.
+// A band reads the bomb rows just outside it as a halo but only writes its own rows.
+void FMinesweeperGameLogic::ComputeAdjacency()
+{
+    MINESWEEPER_SCOPE(Minesweeper_ComputeAdjacency, STAT_MinesweeperComputeAdjacency);
+
+    if (Topology.GetKind() != EMinesweeperTopology::Square)
+    {
+        ComputeAdjacencyByNeighbour();
+        return;
     }
+
+    // Preset boards are tiny: counting around each bomb beats a parallel pass over the planes
+    if (FixedCountAdjacency)
+    {
+        FixedCountAdjacency(Grid.GetData(), BombIndices);
+        return;
+    }
+
+    const int32 BandRows = GetBandRows();
+    const int32 NumBands = FMath::DivideAndRoundUp(Height, BandRows);
+
+    ParallelFor(NumBands, [this, BandRows](int32 Band)
+    {
+        const int32 FirstRow = Band * BandRows;
+        const int32 LastRow = FMath::Min(Height, FirstRow + BandRows);
+
+        // One row's count planes, reused down the band; a 4096-wide row still fits inline
+        TArray<uint64, TInlineAllocator<4 * 64>> AdjPlanes;
+        AdjPlanes.SetNumUninitialized(4 * Bits.GetWordsPerRow());
+        for (int32 y = FirstRow; y < LastRow; ++y)
+        {
+            Bits.CountAdjacencyRow(y, AdjPlanes.GetData());
+            UnpackRow(y, AdjPlanes.GetData());
+        }
+    });
 }
 
-// Counts bombs around a specific tile at (X, Y)
-int32 FMinesweeperGameLogic::CountAdj(int32 X, int32 Y) const
+// Copies one row of bomb bits and adjacency counts from the bit planes into the grid
+void FMinesweeperGameLogic::UnpackRow(int32 Y, const uint64* AdjPlanes)
 {
-    int32 Count = 0;
-    for (int dy = -1; dy <= 1; ++dy)
+    const int32 Words = Bits.GetWordsPerRow();
+    const uint64* BombRow = Bits.GetBombRow(Y);
+    const uint64* AdjRows[4] = { AdjPlanes, AdjPlanes + Words, AdjPlanes + 2 * Words, AdjPlanes + 3 * Words };
+    FMSPTile* Row = Grid.GetData() + GridIndex(0, Y);
+
+    for (int32 w = 0; w < Words; ++w)
     {
-        for (int dx = -1; dx <= 1; ++dx)
+        const uint64 BombWord = BombRow[w];
+        const uint64 A0 = AdjRows[0][w], A1 = AdjRows[1][w], A2 = AdjRows[2][w], A3 = AdjRows[3][w];
+        const int32 Base = w * 64;
+        const int32 Count = FMath::Min(64, Width - Base);
+        for (int32 b = 0; b < Count; ++b)
         {
-            if (dx == 0 && dy == 0) continue;
-            const int32 nx = X + dx, ny = Y + dy;
-            if (IsValid(nx, ny) && Grid[ny * Width + nx].bIsBomb)
-                ++Count;
+            FMSPTile& T = Row[Base + b];
+            T.bIsBomb = uint8((BombWord >> b) & 1);
+            const uint8 Adj = uint8(((A0 >> b) & 1) | (((A1 >> b) & 1) << 1) | (((A2 >> b) & 1) << 2) | (((A3 >> b) & 1) << 3));
+            T.Adjacent = T.bIsBomb ? 0 : Adj;
         }
     }
-    return Count;
 }
 
 // Handles a tile click, updating game state
-//and reporting whether a bomb was hit or tiles changed
-void FMinesweeperGameLogic::Click(int32 X, int32 Y, bool& bOutHitBomb, bool& bOutChanged)
+//and reporting whether a bomb was hit and which tiles changed
+void FMinesweeperGameLogic::Click(int32 X, int32 Y, bool& bOutHitBomb, TArray<int32>& OutChanged)
 {
+    MINESWEEPER_SCOPE(Minesweeper_Click, STAT_MinesweeperClick);
+    ON_SCOPE_EXIT
+    {
+        SET_DWORD_STAT(STAT_MinesweeperTilesRevealedLastClick, OutChanged.Num());
+        INC_DWORD_STAT_BY(STAT_MinesweeperTilesRevealed, OutChanged.Num());
+    };
     bOutHitBomb = false;
-    bOutChanged = false;
-    if (!IsValid(X, Y) || bGameOver) return;
+    OutChanged.Reset();
+    if (!IsValid(X, Y) || bGameOver || Grid[GridIndex(X, Y)].bRevealed || Grid[GridIndex(X, Y)].bFlagged) return;
+
+    PlaceBombsAround(X, Y);
+    OpenTile(X, Y, bOutHitBomb, OutChanged);
+    EndMove(bOutHitBomb, OutChanged);
+}
+
+// Click over a batch: tiles open one after another, but the flag sweep, counters and journal run once at the end.
+// The first point that opens anything places the bombs, as a lone click would.
+int32 FMinesweeperGameLogic::ClickMany(TArrayView<const FIntPoint> Points, bool& bOutHitBomb, TArray<int32>& OutChanged, bool bStopAtRevealed)
+{
+    MINESWEEPER_SCOPE(Minesweeper_Click, STAT_MinesweeperClick);
+    ON_SCOPE_EXIT
+    {
+        SET_DWORD_STAT(STAT_MinesweeperTilesRevealedLastClick, OutChanged.Num());
+        INC_DWORD_STAT_BY(STAT_MinesweeperTilesRevealed, OutChanged.Num());
+    };
+    bOutHitBomb = false;
+    OutChanged.Reset();
+    if (bGameOver) return 0;
 
-    FMSPTile& T = Grid[Y * Width + X];
+    // SafeTilesLeft is only settled by EndMove, so a win part way through shows as every safe tile listed
+    int32 NumDone = 0;
+    for (; NumDone < Points.Num() && !bOutHitBomb && OutChanged.Num() != SafeTilesLeft; ++NumDone)
+    {
+        const FIntPoint& Point = Points[NumDone];
+        if (!IsValid(Point.X, Point.Y)) continue;
+
+        const FMSPTile& T = Grid[GridIndex(Point.X, Point.Y)];
+        if (T.bRevealed && bStopAtRevealed) break;
+        if (T.bRevealed || T.bFlagged) continue;
+
+        PlaceBombsAround(Point.X, Point.Y);
+        OpenTile(Point.X, Point.Y, bOutHitBomb, OutChanged);
+    }
+    EndMove(bOutHitBomb, OutChanged);
+    return NumDone;
+}
+
+// Toggles the flag on a hidden tile and keeps the flag count in step
+void FMinesweeperGameLogic::ToggleFlag(int32 X, int32 Y, TArray<int32>& OutChanged)
+{
+    OutChanged.Reset();
+    if (!IsValid(X, Y) || bGameOver) return;
+    FMSPTile& T = Grid[GridIndex(X, Y)];
     if (T.bRevealed) return;
 
+    const bool bFlag = !T.bFlagged;
+    T.bFlagged = bFlag;
+    FlagsPlaced += bFlag ? 1 : -1;
+    OutChanged.Add(Y * Width + X);
+
+    if (bUndoEnabled)
+    {
+        FJournalEntry& Entry = AddJournalEntry();
+        FlagToggles.Add(Y * Width + X);
+        Entry.NumFlags = 1;
+    }
+}
+
+// Opens the unflagged neighbours of a satisfied number
+void FMinesweeperGameLogic::Chord(int32 X, int32 Y, bool& bOutHitBomb, TArray<int32>& OutChanged)
+{
+    bOutHitBomb = false;
+    OutChanged.Reset();
+    if (!IsValid(X, Y) || bGameOver) return;
+
+    const FMSPTile& T = Grid[GridIndex(X, Y)];
+    if (!T.bRevealed || T.bIsBomb || T.Adjacent == 0) return;
+
+    int32 Flags = 0;
+    Topology.ForEachNeighbour(Y * Width + X, [this, &Flags](int32 N) { Flags += TileAt(N).bFlagged; });
+    if (Flags != T.Adjacent) return;
+
+    Topology.ForEachNeighbour(Y * Width + X, [this, &bOutHitBomb, &OutChanged](int32 N)
+    {
+        if (!bOutHitBomb) OpenTile(N % Width, N / Width, bOutHitBomb, OutChanged);
+    });
+    EndMove(bOutHitBomb, OutChanged);
+}
+
+// Zeros flood, numbers reveal alone, bombs are left to EndMove
+void FMinesweeperGameLogic::OpenTile(int32 X, int32 Y, bool& bOutHitBomb, TArray<int32>& OutChanged)
+{
+    const FMSPTile& T = Grid[GridIndex(X, Y)];
+    if (T.bRevealed || T.bFlagged) return;
+
     if (T.bIsBomb)
     {
         bOutHitBomb = true;
+    }
+    else if (T.Adjacent == 0)
+    {
+        FloodFillZeros(X, Y, OutChanged);
+    }
+    else
+    {
+        Reveal(X, Y, OutChanged);
+    }
+}
+
+// OutChanged holds only safe tiles on entry, so it doubles as the count of newly revealed safe tiles
+void FMinesweeperGameLogic::EndMove(bool bHitBomb, TArray<int32>& OutChanged)
+{
+    if (OutChanged.Num() == 0 && !bHitBomb) return;
+
+    FJournalEntry* Entry = bUndoEnabled ? &AddJournalEntry() : nullptr;
+
+    // Cascades open through flags; the flag is dropped and the tile is already listed as changed
+    if (FlagsPlaced > 0)
+    {
+        for (const int32 Index : OutChanged)
+        {
+            FMSPTile& T = TileAt(Index);
+            if (T.bFlagged)
+            {
+                T.bFlagged = false;
+                --FlagsPlaced;
+                if (Entry)
+                {
+                    FlagToggles.Add(Index);
+                    ++Entry->NumFlags;
+                }
+            }
+        }
+    }
+    SafeTilesLeft -= OutChanged.Num();
+    if (Entry) Entry->SafeRevealed = OutChanged.Num();
+
+    if (bHitBomb)
+    {
+        // Show every bomb; walks the bomb list, not the grid
         bGameOver = true;
-        // Optionally reveal all bombs (not required but useful feedback):
-        for (FMSPTile& R : Grid) if (R.bIsBomb) R.bRevealed = true;
-        bOutChanged = true;
-        return;
+        for (const int32 Index : BombIndices)
+        {
+            TileAt(Index).bRevealed = true;
+            OutChanged.Add(Index);
+        }
+    }
+    else if (SafeTilesLeft == 0)
+    {
+        bGameOver = true;
+        bWon = true;
     }
 
-    Reveal(X, Y);
-    if (T.Adjacent == 0) FloodFillZeros(X, Y);
-    bOutChanged = true;
+    if (Entry)
+    {
+        JournalReveals(*Entry, OutChanged);
+        Entry->bEndedGame = bGameOver;
+        Entry->bWon = bWon;
+    }
+}
+
+// Hides the entry's runs again, restores its flags and counters, and reopens a game it ended
+bool FMinesweeperGameLogic::Undo(TArray<int32>& OutChanged)
+{
+    OutChanged.Reset();
+    if (!CanUndo()) return false;
+
+    const FJournalEntry& Entry = Journal[--JournalCursor];
+    for (int32 r = Entry.FirstRun; r < Entry.FirstRun + Entry.NumRuns; ++r)
+    {
+        const FRevealRun& Run = RevealRuns[r];
+        for (int32 Index = Run.Start; Index < Run.Start + Run.Num; ++Index)
+        {
+            TileAt(Index).bRevealed = false;
+            OutChanged.Add(Index);
+        }
+    }
+    for (int32 f = Entry.FirstFlag; f < Entry.FirstFlag + Entry.NumFlags; ++f)
+    {
+        const int32 Index = FlagToggles[f];
+        FMSPTile& T = TileAt(Index);
+        T.bFlagged = !T.bFlagged;
+        FlagsPlaced += T.bFlagged ? 1 : -1;
+        if (Entry.NumRuns == 0) OutChanged.Add(Index); // flags cleared by a cascade sit on tiles already listed
+    }
+
+    SafeTilesLeft += Entry.SafeRevealed;
+    if (Entry.bEndedGame)
+    {
+        bGameOver = false;
+        bWon = false;
+    }
+    return true;
+}
+
+// Replays the entry's deltas as recorded; nothing is recomputed
+bool FMinesweeperGameLogic::Redo(TArray<int32>& OutChanged)
+{
+    OutChanged.Reset();
+    if (!CanRedo()) return false;
+
+    const FJournalEntry& Entry = Journal[JournalCursor++];
+    for (int32 r = Entry.FirstRun; r < Entry.FirstRun + Entry.NumRuns; ++r)
+    {
+        const FRevealRun& Run = RevealRuns[r];
+        for (int32 Index = Run.Start; Index < Run.Start + Run.Num; ++Index)
+        {
+            TileAt(Index).bRevealed = true;
+            OutChanged.Add(Index);
+        }
+    }
+    for (int32 f = Entry.FirstFlag; f < Entry.FirstFlag + Entry.NumFlags; ++f)
+    {
+        const int32 Index = FlagToggles[f];
+        FMSPTile& T = TileAt(Index);
+        T.bFlagged = !T.bFlagged;
+        FlagsPlaced += T.bFlagged ? 1 : -1;
+        if (Entry.NumRuns == 0) OutChanged.Add(Index);
+    }
+
+    SafeTilesLeft -= Entry.SafeRevealed;
+    bGameOver = Entry.bEndedGame;
+    bWon = Entry.bWon;
+    return true;
+}
+
+void FMinesweeperGameLogic::SetUndoEnabled(bool bEnabled)
+{
+    bUndoEnabled = bEnabled;
+    if (!bUndoEnabled) ResetJournal();
+}
+
+// Truncating keeps the pools' capacity, so a long undo/redo session stops allocating once warmed up
+FMinesweeperGameLogic::FJournalEntry& FMinesweeperGameLogic::AddJournalEntry()
+{
+    if (CanRedo())
+    {
+        const FJournalEntry& FirstUndone = Journal[JournalCursor];
+        RevealRuns.SetNum(FirstUndone.FirstRun, EAllowShrinking::No);
+        FlagToggles.SetNum(FirstUndone.FirstFlag, EAllowShrinking::No);
+        Journal.SetNum(JournalCursor, EAllowShrinking::No);
+    }
+
+    FJournalEntry& Entry = Journal.AddDefaulted_GetRef();
+    Entry.FirstRun = RevealRuns.Num();
+    Entry.FirstFlag = FlagToggles.Num();
+    ++JournalCursor;
+    return Entry;
+}
+
+// Flood fills emit whole row spans in order, so a cascade collapses to roughly one run per row it touched
+void FMinesweeperGameLogic::JournalReveals(FJournalEntry& Entry, TArrayView<const int32> Indices)
+{
+    for (const int32 Index : Indices)
+    {
+        if (Entry.NumRuns > 0)
+        {
+            FRevealRun& Last = RevealRuns.Last();
+            if (Last.Start + Last.Num == Index)
+            {
+                ++Last.Num;
+                continue;
+            }
+        }
+        RevealRuns.Add({ Index, 1 });
+        ++Entry.NumRuns;
+    }
+}
+
+void FMinesweeperGameLogic::ResetJournal()
+{
+    Journal.Reset();
+    RevealRuns.Reset();
+    FlagToggles.Reset();
+    JournalCursor = 0;
+}
+
+// Scans the bomb plane a word at a time
+void FMinesweeperGameLogic::CollectBombIndices()
+{
+    BombIndices.Reset();
+    for (int32 y = 0; y < Height; ++y)
+    {
+        const uint64* Row = Bits.GetBombRow(y);
+        for (int32 w = 0; w < Bits.GetWordsPerRow(); ++w)
+        {
+            for (uint64 Word = Row[w]; Word != 0; Word &= Word - 1)
+            {
+                BombIndices.Add(y * Width + w * 64 + int32(FMath::CountTrailingZeros64(Word)));
+            }
+        }
+    }
 }
 
 // Marks a specific tile as revealed
-void FMinesweeperGameLogic::Reveal(int32 X, int32 Y)
+void FMinesweeperGameLogic::Reveal(int32 X, int32 Y, TArray<int32>& OutChanged)
 {
     if (!IsValid(X, Y)) return;
-    FMSPTile& T = Grid[Y * Width + X];
+    FMSPTile& T = Grid[GridIndex(X, Y)];
+    if (T.bRevealed) return;
     T.bRevealed = true;
+    OutChanged.Add(Y * Width + X);
 }
 
-// Reveals all connected tiles with zero adjacent bombs using a flood-fill algorithm
-void FMinesweeperGameLogic::FloodFillZeros(int32 StartX, int32 StartY)
+// Reveals all connected tiles with zero adjacent bombs plus their border, one horizontal run at a time.
+// Neighbours of a zero tile are never bombs, so no bomb checks are needed inside the fill.
+void FMinesweeperGameLogic::FloodFillZeros(int32 StartX, int32 StartY, TArray<int32>& OutChanged)
 {
-    TQueue<FIntPoint> Q;
-    Q.Enqueue(FIntPoint(StartX, StartY));
+    MINESWEEPER_SCOPE(Minesweeper_FloodFillZeros, STAT_MinesweeperFloodFillZeros);
+    if (Topology.GetKind() != EMinesweeperTopology::Square)
+    {
+        FloodFillByNeighbour(StartY * Width + StartX, OutChanged);
+        return;
+    }
+    if (FixedFloodFill)
+    {
+        FixedFloodFill(Grid.GetData(), StartX, StartY, FixedStack, OutChanged);
+        return;
+    }
+
+    FloodStack.Reset();
+    FloodStack.Add(FIntPoint(StartX, StartY));
 
-    while (!Q.IsEmpty())
+    while (FloodStack.Num() > 0)
     {
-        FIntPoint P;
-        Q.Dequeue(P);
-        for (int dy = -1; dy <= 1; ++dy)
+        const FIntPoint Seed = FloodStack.Pop(EAllowShrinking::No);
+        FMSPTile* Row = Grid.GetData() + GridIndex(0, Seed.Y);
+        if (Row[Seed.X].bRevealed) continue;
+
+        // Widen the seed to the full run of unrevealed zeros on its row
+        int32 Left = Seed.X;
+        while (Left > 0 && !Row[Left - 1].bRevealed && Row[Left - 1].Adjacent == 0) --Left;
+        int32 Right = Seed.X;
+        while (Right + 1 < Width && !Row[Right + 1].bRevealed && Row[Right + 1].Adjacent == 0) ++Right;
+
+        // The run and its left/right border tiles are revealed together
+        const int32 SpanMin = FMath::Max(0, Left - 1);
+        const int32 SpanMax = FMath::Min(Width - 1, Right + 1);
+        for (int32 x = SpanMin; x <= SpanMax; ++x)
         {
-            for (int dx = -1; dx <= 1; ++dx)
+            if (!Row[x].bRevealed)
             {
-                if (dx == 0 && dy == 0) continue;
-                const int32 nx = P.X + dx, ny = P.Y + dy;
-                if (!IsValid(nx, ny)) continue;
+                Row[x].bRevealed = true;
+                OutChanged.Add(Seed.Y * Width + x);
+            }
+        }
+
+        // Rows above and below: reveal numbered tiles, seed one entry per run of zeros
+        for (int32 ny = Seed.Y - 1; ny <= Seed.Y + 1; ny += 2)
+        {
+            if (ny < 0 || ny >= Height) continue;
 
-                FMSPTile& N = Grid[ny * Width + nx];
-                if (!N.bRevealed && !N.bIsBomb)
+            FMSPTile* NRow = Grid.GetData() + GridIndex(0, ny);
+            bool bInZeroRun = false;
+            for (int32 x = SpanMin; x <= SpanMax; ++x)
+            {
+                FMSPTile& N = NRow[x];
+                if (N.bRevealed)
+                {
+                    bInZeroRun = false;
+                }
+                else if (N.Adjacent == 0)
+                {
+                    if (!bInZeroRun) FloodStack.Add(FIntPoint(x, ny));
+                    bInZeroRun = true;
+                }
+                else
                 {
                     N.bRevealed = true;
-                    if (N.Adjacent == 0)
-                    {
-                        Q.Enqueue(FIntPoint(nx, ny));
-                    }
+                    OutChanged.Add(ny * Width + x);
+                    bInZeroRun = false;
                 }
             }
         }
     }
+}
+
+// Counts around each bomb through the topology, the way the fixed-size kernels do on the square grid
+void FMinesweeperGameLogic::ComputeAdjacencyByNeighbour()
+{
+    for (const int32 Index : BombIndices)
+    {
+        TileAt(Index).bIsBomb = true;
+        Topology.ForEachNeighbour(Index, [this](int32 N) { ++TileAt(N).Adjacent; });
+    }
+
+    // Bomb tiles carry no count
+    for (const int32 Index : BombIndices)
+    {
+        TileAt(Index).Adjacent = 0;
+    }
+}
+
+// Depth-first fill through the topology; as on the square grid, neighbours of a zero tile are never bombs
+void FMinesweeperGameLogic::FloodFillByNeighbour(int32 Start, TArray<int32>& OutChanged)
+{
+    TileAt(Start).bRevealed = true;
+    OutChanged.Add(Start);
+
+    FixedStack.Reset();
+    FixedStack.Add(Start);
+    while (FixedStack.Num() > 0)
+    {
+        const int32 Index = FixedStack.Pop(EAllowShrinking::No);
+        Topology.ForEachNeighbour(Index, [this, &OutChanged](int32 N)
+        {
+            FMSPTile& T = TileAt(N);
+            if (T.bRevealed) return;
+
+            T.bRevealed = true;
+            OutChanged.Add(N);
+            if (T.Adjacent == 0) FixedStack.Add(N);
+        });
+    }
 }
\ No newline at end of file
@@ -0,0 +1,414 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "MinesweeperProbability.h"
+#include "MinesweeperGameLogic.h"
+#include "MinesweeperStats.h"
+#include "Hash/CityHash.h"
+#include <cmath>
+
+DECLARE_CYCLE_STAT(TEXT("Mine probabilities"), STAT_MinesweeperProbability, STATGROUP_Minesweeper);
+
+namespace
+{
+    // Upper bound on search nodes per component so one huge component cannot hold up the rest
+    constexpr int32 MaxEnumerationNodes = 1 << 22;
+
+    // Multiply-adds allowed for combining components exactly; past it they are weighted independently
+    constexpr int64 MaxCombineWork = 50000000;
+
+    // Distribution of the sum of two independent mine totals
+    void Convolve(TArrayView<const double> A, TArrayView<const double> B, TArray<double>& Out)
+    {
+        Out.Reset();
+        Out.SetNumZeroed(A.Num() + B.Num() - 1);
+        for (int32 a = 0; a < A.Num(); ++a)
+        {
+            if (A[a] == 0.0) continue;
+            for (int32 b = 0; b < B.Num(); ++b)
+            {
+                Out[a + b] += A[a] * B[b];
+            }
+        }
+    }
+
+    // log of N choose K
+    double LogChoose(int32 N, int32 K)
+    {
+        return std::lgamma(N + 1.0) - std::lgamma(K + 1.0) - std::lgamma(N - K + 1.0);
+    }
+}
+
+void FMinesweeperProbability::Snapshot(const FMinesweeperGameLogic& Game, TArray<uint8>& OutVisible)
+{
+    const int32 W = Game.GetWidth();
+    const int32 H = Game.GetHeight();
+    OutVisible.SetNumUninitialized(W * H);
+    for (int32 y = 0; y < H; ++y)
+    {
+        for (int32 x = 0; x < W; ++x)
+        {
+            const FMSPTile& T = Game.Get(x, y);
+            OutVisible[y * W + x] = T.bRevealed ? uint8(T.Adjacent) : Hidden;
+        }
+    }
+}
+
+void FMinesweeperProbability::Snapshot(const FMinesweeperGameLogic& Game, TArrayView<const int32> Tiles, TArray<uint8>& OutValues)
+{
+    OutValues.SetNumUninitialized(Tiles.Num());
+    for (int32 i = 0; i < Tiles.Num(); ++i)
+    {
+        const FMSPTile& T = Game.GetByIndex(Tiles[i]);
+        OutValues[i] = T.bRevealed ? uint8(T.Adjacent) : Hidden;
+    }
+}
+
+void FMinesweeperProbability::SetVisible(TArray<uint8>&& InVisible)
+{
+    check(InVisible.Num() == Topology.GetWidth() * Topology.GetHeight());
+    KeptVisible = MoveTemp(InVisible);
+}
+
+// A tile listed twice takes its later value, which is the same one: both come from one Snapshot
+void FMinesweeperProbability::UpdateVisible(TArrayView<const int32> Tiles, TArrayView<const uint8> Values)
+{
+    check(Tiles.Num() == Values.Num());
+    for (int32 i = 0; i < Tiles.Num(); ++i)
+    {
+        KeptVisible[Tiles[i]] = Values[i];
+    }
+}
+
+void FMinesweeperProbability::Reset(const FMinesweeperTopology& InTopology, int32 InBombs)
+{
+    Topology = InTopology;
+    Bombs = InBombs;
+    Cache.Reset();
+    KeptVisible.Init(Hidden, Topology.GetWidth() * Topology.GetHeight());
+}
+
+// Backtracks over the tiles in order, pruning as soon as a constraint can no longer be met
+void FMinesweeperProbability::Enumerate(FComponent& C, const TArray<TArray<int32, TInlineAllocator<8>>>& ConstraintTiles, const TArray<int32>& ConstraintMines,
+    const std::atomic<bool>& bCancel) const
+{
+    const int32 NumTiles = C.Tiles.Num();
+    const int32 NumConstraints = ConstraintTiles.Num();
+
+    TArray<TArray<int32, TInlineAllocator<8>>> TileConstraints;
+    TileConstraints.SetNum(NumTiles);
+    TArray<int32> Assigned, Remaining;
+    Assigned.SetNumZeroed(NumConstraints);
+    Remaining.SetNumUninitialized(NumConstraints);
+    for (int32 c = 0; c < NumConstraints; ++c)
+    {
+        Remaining[c] = ConstraintTiles[c].Num();
+        for (const int32 t : ConstraintTiles[c]) TileConstraints[t].Add(c);
+    }
+
+    C.Ways.Reset();
+    C.Ways.SetNumZeroed(NumTiles + 1);
+    C.TileWays.Reset();
+    C.TileWays.SetNumZeroed((NumTiles + 1) * NumTiles);
+
+    TArray<int32, TInlineAllocator<MaxComponentTiles>> Mines;
+    int32 Nodes = 0;
+    bool bAborted = false;
+
+    TFunction<void(int32)> Assign = [&](int32 i)
+    {
+        if (bAborted) return;
+        if (++Nodes > MaxEnumerationNodes || ((Nodes & 4095) == 0 && bCancel.load(std::memory_order_relaxed)))
+        {
+            bAborted = true;
+            return;
+        }
+
+        if (i == NumTiles)
+        {
+            const int32 m = Mines.Num();
+            C.Ways[m] += 1.0;
+            for (const int32 t : Mines) C.TileWays[m * NumTiles + t] += 1.0;
+            return;
+        }
+
+        for (int32 bMine = 0; bMine <= 1; ++bMine)
+        {
+            bool bConsistent = true;
+            for (const int32 c : TileConstraints[i])
+            {
+                Assigned[c] += bMine;
+                --Remaining[c];
+                bConsistent &= Assigned[c] <= ConstraintMines[c] && Assigned[c] + Remaining[c] >= ConstraintMines[c];
+            }
+            if (bConsistent)
+            {
+                if (bMine) Mines.Add(i);
+                Assign(i + 1);
+                if (bMine) Mines.Pop(EAllowShrinking::No);
+            }
+            for (const int32 c : TileConstraints[i])
+            {
+                Assigned[c] -= bMine;
+                ++Remaining[c];
+            }
+        }
+    };
+    Assign(0);
+
+    double Total = 0.0;
+    int32 MaxMines = 0;
+    for (int32 m = 0; m <= NumTiles; ++m)
+    {
+        Total += C.Ways[m];
+        if (C.Ways[m] > 0.0) MaxMines = m;
+    }
+    C.bExact = !bAborted && Total > 0.0;
+    if (!C.bExact) return;
+
+    // Totals above the largest possible one only widen every convolution
+    C.Ways.SetNum(MaxMines + 1);
+    C.TileWays.SetNum((MaxMines + 1) * NumTiles);
+    for (double& W : C.Ways) W /= Total;
+    for (double& W : C.TileWays) W /= Total;
+}
+
+bool FMinesweeperProbability::Compute(TArrayView<const uint8> Visible, TArray<float>& OutProbability, const std::atomic<bool>& bCancel)
+{
+    MINESWEEPER_SCOPE(Minesweeper_Probability, STAT_MinesweeperProbability);
+    const int32 NumTiles = Topology.GetWidth() * Topology.GetHeight();
+    check(Visible.Num() == NumTiles);
+    LastEnumerated = 0;
+    LastCached = 0;
+
+    // Frontier tiles get a slot each; a union-find over the slots joins tiles that share a constraint
+    TArray<int32> Slot;
+    Slot.Init(INDEX_NONE, NumTiles);
+    TArray<int32> FrontierTiles;
+    TArray<int32> Parent;
+    TArray<int32> Constraints;
+    int32 NumHidden = 0;
+    auto FindRoot = [&Parent](int32 S)
+    {
+        while (Parent[S] != S)
+        {
+            Parent[S] = Parent[Parent[S]];
+            S = Parent[S];
+        }
+        return S;
+    };
+
+    for (int32 i = 0; i < NumTiles; ++i)
+    {
+        if (Visible[i] == Hidden)
+        {
+            ++NumHidden;
+            continue;
+        }
+
+        int32 Root = INDEX_NONE;
+        Topology.ForEachNeighbour(i, [&](int32 N)
+        {
+            if (Visible[N] != Hidden) return;
+            if (Slot[N] == INDEX_NONE)
+            {
+                Slot[N] = FrontierTiles.Num();
+                FrontierTiles.Add(N);
+                Parent.Add(Slot[N]);
+            }
+            const int32 NRoot = FindRoot(Slot[N]);
+            if (Root == INDEX_NONE) Root = NRoot;
+            else if (NRoot != Root) Parent[NRoot] = Root;
+        });
+        if (Root != INDEX_NONE) Constraints.Add(i);
+    }
+
+    // Constraints grouped by component, in board order
+    TMap<int32, int32> ComponentOfRoot;
+    TArray<TArray<int32>> ComponentConstraints;
+    for (const int32 Tile : Constraints)
+    {
+        int32 Root = INDEX_NONE;
+        Topology.ForEachNeighbour(Tile, [&](int32 N) { if (Root == INDEX_NONE && Slot[N] != INDEX_NONE && Visible[N] == Hidden) Root = FindRoot(Slot[N]); });
+        int32& Component = ComponentOfRoot.FindOrAdd(Root, INDEX_NONE);
+        if (Component == INDEX_NONE) Component = ComponentConstraints.AddDefaulted();
+        ComponentConstraints[Component].Add(Tile);
+    }
+
+    // Look each component up by its shape, enumerating only the ones not seen last time
+    TMap<uint64, FComponent> NextCache;
+    TArray<uint64> Keys;
+    TArray<int32> LocalIndex;
+    LocalIndex.Init(INDEX_NONE, FrontierTiles.Num());
+    for (const TArray<int32>& Group : ComponentConstraints)
+    {
+        if (bCancel.load(std::memory_order_relaxed))
+        {
+            Cache.Append(MoveTemp(NextCache));
+            return false;
+        }
+
+        // Tiles in the order the constraints reach them, so each constraint closes soon after its first tile
+        FComponent Component;
+        TArray<TArray<int32, TInlineAllocator<8>>> ConstraintTiles;
+        TArray<int32> ConstraintMines;
+        TArray<uint32> Key;
+        for (const int32 Tile : Group)
+        {
+            TArray<int32, TInlineAllocator<8>>& Local = ConstraintTiles.AddDefaulted_GetRef();
+            ConstraintMines.Add(Visible[Tile]);
+            Key.Add(uint32(Tile));
+            Key.Add(Visible[Tile]);
+            Topology.ForEachNeighbour(Tile, [&](int32 N)
+            {
+                if (Visible[N] != Hidden) return;
+                int32& L = LocalIndex[Slot[N]];
+                if (L == INDEX_NONE)
+                {
+                    L = Component.Tiles.Num();
+                    Component.Tiles.Add(N);
+                }
+                Local.Add(L);
+            });
+        }
+        Key.Add(MAX_uint32);
+        for (const int32 Tile : Component.Tiles) Key.Add(uint32(Tile));
+
+        const uint64 Hash = CityHash64(reinterpret_cast<const char*>(Key.GetData()), Key.Num() * sizeof(uint32));
+        Keys.Add(Hash);
+        if (FComponent* Cached = Cache.Find(Hash))
+        {
+            NextCache.Add(Hash, MoveTemp(*Cached));
+            ++LastCached;
+            continue;
+        }
+
+        if (Component.Tiles.Num() <= MaxComponentTiles)
+        {
+            Enumerate(Component, ConstraintTiles, ConstraintMines, bCancel);
+            if (bCancel.load(std::memory_order_relaxed))
+            {
+                Cache.Append(MoveTemp(NextCache));
+                return false;
+            }
+        }
+        else
+        {
+            Component.bExact = false;
+        }
+        ++LastEnumerated;
+        NextCache.Add(Hash, MoveTemp(Component));
+    }
+    Cache = MoveTemp(NextCache);
+
+    // Tiles outside the exact components share whatever bombs the components leave
+    TArray<const FComponent*> Exact;
+    int32 ExactTiles = 0;
+    int32 MaxFrontierMines = 0;
+    for (const uint64 Hash : Keys)
+    {
+        const FComponent& Component = Cache.FindChecked(Hash);
+        if (!Component.bExact) continue;
+        Exact.Add(&Component);
+        ExactTiles += Component.Tiles.Num();
+        MaxFrontierMines += Component.Ways.Num() - 1;
+    }
+    const int32 Unconstrained = NumHidden - ExactTiles;
+
+    OutProbability.Init(-1.f, NumTiles);
+
+    // Ways to put the other Bombs - k bombs on the unconstrained tiles, relative to the most likely k
+    TArray<double> Weights;
+    Weights.SetNumZeroed(MaxFrontierMines + 1);
+    double MaxLog = -DBL_MAX;
+    for (int32 k = 0; k <= MaxFrontierMines; ++k)
+    {
+        const int32 Rest = Bombs - k;
+        if (Rest >= 0 && Rest <= Unconstrained) MaxLog = FMath::Max(MaxLog, LogChoose(Unconstrained, Rest));
+    }
+    if (MaxLog == -DBL_MAX) return true; // nothing fits: the view is inconsistent
+    for (int32 k = 0; k <= MaxFrontierMines; ++k)
+    {
+        const int32 Rest = Bombs - k;
+        if (Rest >= 0 && Rest <= Unconstrained) Weights[k] = std::exp(LogChoose(Unconstrained, Rest) - MaxLog);
+    }
+
+    double UnconstrainedDensity = 0.0;
+    const int32 NumExact = Exact.Num();
+    if (int64(NumExact) * (MaxFrontierMines + 1) * (MaxFrontierMines + 1) <= MaxCombineWork)
+    {
+        // Mine totals of components [0, c) and [c, NumExact), so each component can be combined with all the others
+        TArray<TArray<double>> Prefix, Suffix;
+        Prefix.SetNum(NumExact + 1);
+        Suffix.SetNum(NumExact + 1);
+        Prefix[0] = { 1.0 };
+        Suffix[NumExact] = { 1.0 };
+        for (int32 c = 0; c < NumExact; ++c) Convolve(Prefix[c], Exact[c]->Ways, Prefix[c + 1]);
+        for (int32 c = NumExact - 1; c >= 0; --c) Convolve(Exact[c]->Ways, Suffix[c + 1], Suffix[c]);
+
+        double Z = 0.0, UnconstrainedMines = 0.0;
+        const TArray<double>& Total = Prefix[NumExact];
+        for (int32 k = 0; k < Total.Num(); ++k)
+        {
+            Z += Total[k] * Weights[k];
+            UnconstrainedMines += Total[k] * Weights[k] * (Bombs - k);
+        }
+        if (Z <= 0.0) return true;
+        UnconstrainedDensity = Unconstrained > 0 ? UnconstrainedMines / Z / Unconstrained : 0.0;
+
+        TArray<double> Others, ByMines;
+        for (int32 c = 0; c < NumExact; ++c)
+        {
+            const FComponent& Component = *Exact[c];
+            const int32 NumComponentTiles = Component.Tiles.Num();
+            Convolve(Prefix[c], Suffix[c + 1], Others);
+
+            // Weight of this component holding m mines, summed over every total of the others
+            ByMines.SetNumZeroed(Component.Ways.Num());
+            for (int32 m = 0; m < Component.Ways.Num(); ++m)
+            {
+                ByMines[m] = 0.0;
+                for (int32 k = 0; k < Others.Num(); ++k) ByMines[m] += Others[k] * Weights[m + k];
+            }
+            for (int32 t = 0; t < NumComponentTiles; ++t)
+            {
+                double P = 0.0;
+                for (int32 m = 0; m < Component.Ways.Num(); ++m) P += Component.TileWays[m * NumComponentTiles + t] * ByMines[m];
+                OutProbability[Component.Tiles[t]] = float(P / Z);
+            }
+        }
+    }
+    else
+    {
+        // Too many components to combine exactly: weight each one on its own by the odds of the unconstrained tiles,
+        // which is what the exact weights tend to when the unconstrained area dwarfs the frontier
+        double ExpectedFrontierMines = 0.0;
+        for (const FComponent* Component : Exact)
+        {
+            for (int32 m = 0; m < Component->Ways.Num(); ++m) ExpectedFrontierMines += m * Component->Ways[m];
+        }
+        UnconstrainedDensity = FMath::Clamp((Bombs - ExpectedFrontierMines) / FMath::Max(1, Unconstrained), 1e-9, 1.0 - 1e-9);
+        const double LogOdds = std::log(UnconstrainedDensity / (1.0 - UnconstrainedDensity));
+
+        for (const FComponent* Component : Exact)
+        {
+            const int32 NumComponentTiles = Component->Tiles.Num();
+            const int32 NumTotals = Component->Ways.Num();
+            double Z = 0.0;
+            for (int32 m = 0; m < NumTotals; ++m) Z += Component->Ways[m] * std::exp((m - (NumTotals - 1)) * LogOdds);
+            for (int32 t = 0; t < NumComponentTiles; ++t)
+            {
+                double P = 0.0;
+                for (int32 m = 0; m < NumTotals; ++m) P += Component->TileWays[m * NumComponentTiles + t] * std::exp((m - (NumTotals - 1)) * LogOdds);
+                OutProbability[Component->Tiles[t]] = Z > 0.0 ? float(P / Z) : -1.f;
+            }
+        }
+    }
+
+    // Every hidden tile not in an exact component shares the unconstrained density; oversized components stay unknown
+    for (int32 i = 0; i < NumTiles; ++i)
+    {
+        if (Visible[i] == Hidden && Slot[i] == INDEX_NONE) OutProbability[i] = float(UnconstrainedDensity);
+    }
+    return true;
+}
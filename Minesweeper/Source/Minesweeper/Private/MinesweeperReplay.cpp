@@ -0,0 +1,203 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "MinesweeperReplay.h"
+#include "MinesweeperGameLogic.h"
+#include "MinesweeperVarInt.h"
+#include "HAL/FileManager.h"
+
+namespace
+{
+    // File header: magic plus a format version
+    constexpr uint8 ReplayMagic[4] = { 'M', 'S', 'R', 'P' };
+    constexpr uint8 ReplayVersion = FMinesweeperReplay::FormatVersion;
+
+    // Bits of the time delta varint taken by the move kind
+    constexpr uint32 MoveKindBits = 2;
+
+    // Guards the reader against garbage lengths
+    constexpr uint32 MaxRecordBytes = 64u << 20;
+
+    using MinesweeperVarInt::WriteUInt;
+    using MinesweeperVarInt::WriteInt;
+    using MinesweeperVarInt::ReadUInt;
+    using MinesweeperVarInt::ReadInt;
+}
+
+// Encodes the payload into Out behind a varint length prefix
+void FMinesweeperReplay::Encode(TArray<uint8>& Out) const
+{
+    // Short games encode without touching the heap
+    TArray<uint8, TInlineAllocator<256>> Bytes;
+    Bytes.Reserve(16 + Moves.Num() * 3);
+    WriteUInt(Bytes, uint32(Width));
+    WriteUInt(Bytes, uint32(Height));
+    WriteUInt(Bytes, uint32(Bombs));
+    WriteInt(Bytes, Seed);
+    WriteUInt(Bytes, uint32(Topology));
+    WriteUInt(Bytes, uint32(Generator));
+    WriteUInt(Bytes, uint32(Moves.Num()));
+
+    FMinesweeperReplayMove Prev;
+    for (const FMinesweeperReplayMove& Move : Moves)
+    {
+        WriteInt(Bytes, Move.X - Prev.X);
+        WriteInt(Bytes, Move.Y - Prev.Y);
+        WriteUInt(Bytes, ((Move.TimeMs - Prev.TimeMs) << MoveKindBits) | uint32(Move.Kind));
+        Prev = Move;
+    }
+
+    WriteUInt(Out, uint32(Bytes.Num()));
+    Out.Append(Bytes);
+}
+
+bool FMinesweeperReplay::Decode(TArrayView<const uint8> Payload)
+{
+    int32 Pos = 0;
+    uint32 W = 0, H = 0, B = 0, TopologyKind = 0, GeneratorKind = 0, NumMoves = 0;
+    if (!ReadUInt(Payload, Pos, W) || !ReadUInt(Payload, Pos, H) || !ReadUInt(Payload, Pos, B) || !ReadInt(Payload, Pos, Seed)
+        || !ReadUInt(Payload, Pos, TopologyKind) || !ReadUInt(Payload, Pos, GeneratorKind) || !ReadUInt(Payload, Pos, NumMoves))
+    {
+        return false;
+    }
+    if (TopologyKind >= uint32(EMinesweeperTopology::Graph) || GeneratorKind > uint32(EMinesweeperGenerator::Counter)) return false;
+    if (W < 1 || H < 1 || W > uint32(FMinesweeperGameLogic::MaxSide) || H > uint32(FMinesweeperGameLogic::MaxSide)) return false;
+    if (uint64(W) * H > uint64(MAX_int32) || B >= W * H) return false;
+    Topology = EMinesweeperTopology(TopologyKind);
+    Generator = EMinesweeperGenerator(GeneratorKind);
+
+    // Every move takes at least three bytes, which bounds the count before reserving
+    if (NumMoves > uint32(Payload.Num() - Pos) / 3) return false;
+
+    Width = int32(W);
+    Height = int32(H);
+    Bombs = int32(B);
+    Moves.Reset(NumMoves);
+
+    FMinesweeperReplayMove Prev;
+    for (uint32 i = 0; i < NumMoves; ++i)
+    {
+        int32 DX = 0, DY = 0;
+        uint32 DT = 0;
+        if (!ReadInt(Payload, Pos, DX) || !ReadInt(Payload, Pos, DY) || !ReadUInt(Payload, Pos, DT)) return false;
+
+        const uint32 KindBits = DT & ((1u << MoveKindBits) - 1);
+        if (KindBits > uint32(EMinesweeperMoveKind::Chord)) return false;
+        DT >>= MoveKindBits;
+
+        FMinesweeperReplayMove& Move = Moves.AddDefaulted_GetRef();
+        Move.X = Prev.X + DX;
+        Move.Y = Prev.Y + DY;
+        Move.TimeMs = Prev.TimeMs + DT;
+        Move.Kind = EMinesweeperMoveKind(KindBits);
+        Prev = Move;
+    }
+    return Pos == Payload.Num();
+}
+
+// Rebuilds the board from its seed and re-applies the recorded moves; consecutive reveals go in as one ClickMany
+bool FMinesweeperReplay::Play(FMinesweeperGameLogic& Game, TArray<int32>& ScratchChanged) const
+{
+    Game.SetTopology(Topology);
+    Game.SetGenerator(Generator);
+    Game.NewGame(Width, Height, Bombs, Seed);
+
+    TArray<FIntPoint, TInlineAllocator<64>> Reveals;
+    for (int32 i = 0; i < Moves.Num();)
+    {
+        const FMinesweeperReplayMove& Move = Moves[i];
+        bool bHitBomb = false;
+        switch (Move.Kind)
+        {
+        case EMinesweeperMoveKind::Reveal:
+            Reveals.Reset();
+            for (; i < Moves.Num() && Moves[i].Kind == EMinesweeperMoveKind::Reveal; ++i)
+            {
+                Reveals.Add(FIntPoint(Moves[i].X, Moves[i].Y));
+            }
+            Game.ClickMany(Reveals, bHitBomb, ScratchChanged);
+            break;
+        case EMinesweeperMoveKind::Flag:  Game.ToggleFlag(Move.X, Move.Y, ScratchChanged); ++i; break;
+        case EMinesweeperMoveKind::Chord: Game.Chord(Move.X, Move.Y, bHitBomb, ScratchChanged); ++i; break;
+        }
+        if (bHitBomb) return true;
+    }
+    return false;
+}
+
+bool FMinesweeperReplayWriter::Open(const FString& Path)
+{
+    const bool bNewFile = IFileManager::Get().FileSize(*Path) <= 0;
+
+    // Records of different versions cannot share a file
+    if (!bNewFile)
+    {
+        FMinesweeperReplayReader Existing;
+        if (!Existing.Open(Path)) return false;
+    }
+    Ar.Reset(IFileManager::Get().CreateFileWriter(*Path, FILEWRITE_Append | FILEWRITE_AllowRead));
+    if (!Ar.IsValid()) return false;
+
+    if (bNewFile)
+    {
+        uint8 Header[5] = { ReplayMagic[0], ReplayMagic[1], ReplayMagic[2], ReplayMagic[3], ReplayVersion };
+        Ar->Serialize(Header, sizeof(Header));
+    }
+    return true;
+}
+
+void FMinesweeperReplayWriter::Append(const FMinesweeperReplay& Replay)
+{
+    Scratch.Reset();
+    Replay.Encode(Scratch);
+    AppendEncoded(Scratch);
+}
+
+void FMinesweeperReplayWriter::AppendEncoded(TArrayView<const uint8> Records)
+{
+    if (Ar.IsValid() && Records.Num() > 0)
+    {
+        Ar->Serialize(const_cast<uint8*>(Records.GetData()), Records.Num());
+    }
+}
+
+void FMinesweeperReplayWriter::Close()
+{
+    if (Ar.IsValid())
+    {
+        Ar->Close();
+        Ar.Reset();
+    }
+}
+
+bool FMinesweeperReplayReader::Open(const FString& Path)
+{
+    Ar.Reset(IFileManager::Get().CreateFileReader(*Path));
+    if (!Ar.IsValid()) return false;
+
+    uint8 Header[5] = {};
+    if (Ar->TotalSize() < int64(sizeof(Header))) return false;
+    Ar->Serialize(Header, sizeof(Header));
+    return FMemory::Memcmp(Header, ReplayMagic, sizeof(ReplayMagic)) == 0 && Header[4] == ReplayVersion;
+}
+
+bool FMinesweeperReplayReader::Next(FMinesweeperReplay& Out)
+{
+    if (!Ar.IsValid() || Ar->AtEnd()) return false;
+
+    // Length prefix, read byte by byte from the archive's own buffer
+    uint32 Length = 0;
+    for (int32 Shift = 0;; Shift += 7)
+    {
+        if (Shift >= 35 || Ar->AtEnd()) return false;
+        uint8 Byte = 0;
+        Ar->Serialize(&Byte, 1);
+        Length |= uint32(Byte & 0x7F) << Shift;
+        if (!(Byte & 0x80)) break;
+    }
+    if (Length > MaxRecordBytes || int64(Length) > Ar->TotalSize() - Ar->Tell()) return false;
+
+    Buffer.SetNumUninitialized(int32(Length), EAllowShrinking::No);
+    Ar->Serialize(Buffer.GetData(), Length);
+    return !Ar->IsError() && Out.Decode(Buffer);
+}
@@ -0,0 +1,273 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "MinesweeperSimCommandlet.h"
+#include "MinesweeperGameLogic.h"
+#include "MinesweeperSolver.h"
+#include "MinesweeperReplay.h"
+#include "Async/ParallelFor.h"
+#include "Async/TaskGraphInterfaces.h"
+#include "Misc/Parse.h"
+#include "Misc/ScopeLock.h"
+#include <atomic>
+
+DEFINE_LOG_CATEGORY_STATIC(LogMinesweeperSim, Log, All);
+
+namespace
+{
+    // Encoded replays a worker buffers before taking the file lock
+    constexpr int32 ReplayFlushBytes = 1 << 20;
+
+    // Cascade sizes are bucketed by power of two: bucket N holds reveals of [2^N, 2^(N+1)) tiles
+    constexpr int32 NumCascadeBuckets = 24;
+
+    enum class ESimPolicy : uint8
+    {
+        Random,
+        Solver
+    };
+
+    struct FSimStats
+    {
+        int64 Games = 0;
+        int64 Wins = 0;
+        int64 Moves = 0;
+        int64 Cascades[NumCascadeBuckets] = {};
+
+        void Merge(const FSimStats& Other)
+        {
+            Games += Other.Games;
+            Wins += Other.Wins;
+            Moves += Other.Moves;
+            for (int32 b = 0; b < NumCascadeBuckets; ++b) Cascades[b] += Other.Cascades[b];
+        }
+    };
+
+    // Everything one worker needs to play games back to back without allocating per game
+    struct FSimWorker
+    {
+        FMinesweeperGameLogic Game;
+        FMinesweeperSolver Solver;
+        TArray<int32> Changed;
+        FSimStats Stats;
+
+        FSimWorker()
+        {
+            Game.SetUndoEnabled(false);
+        }
+
+        // Set when replays are written: the game being played and the encoded games not yet flushed
+        bool bRecord = false;
+        FMinesweeperReplay Replay;
+        TArray<uint8> ReplayBytes;
+
+        // Random hidden tile that the solver does not know to be a mine; rejection sampling, then a scan
+        int32 PickRandomHidden(FRandomStream& Rng) const
+        {
+            const int32 NumTiles = Game.GetWidth() * Game.GetHeight();
+            for (int32 Try = 0; Try < 64; ++Try)
+            {
+                const int32 Index = Rng.RandRange(0, NumTiles - 1);
+                if (!Game.GetByIndex(Index).bRevealed && !Solver.IsKnownMine(Index)) return Index;
+            }
+            const int32 Offset = Rng.RandRange(0, NumTiles - 1);
+            for (int32 i = 0; i < NumTiles; ++i)
+            {
+                const int32 Index = (Offset + i) % NumTiles;
+                if (!Game.GetByIndex(Index).bRevealed && !Solver.IsKnownMine(Index)) return Index;
+            }
+            return INDEX_NONE;
+        }
+
+        void Play(int32 W, int32 H, int32 Bombs, int32 Seed, ESimPolicy Policy)
+        {
+            Game.NewGame(W, H, Bombs, Seed);
+            Solver.Reset(Game);
+            FRandomStream Rng(Seed);
+            if (bRecord)
+            {
+                Replay.Width = W;
+                Replay.Height = H;
+                Replay.Bombs = Bombs;
+                Replay.Seed = Seed;
+                Replay.Topology = Game.GetTopology().GetKind();
+                Replay.Generator = Game.GetGenerator();
+                Replay.Moves.Reset();
+            }
+
+            bool bHitBomb = false;
+            while (!Game.IsGameOver())
+            {
+                int32 Target = INDEX_NONE;
+                if (Policy == ESimPolicy::Solver)
+                {
+                    Solver.Solve();
+                    Solver.PopSafeTile(Target);
+                }
+                if (Target == INDEX_NONE)
+                {
+                    Target = PickRandomHidden(Rng);
+                    if (Target == INDEX_NONE) break;
+                }
+
+                const int32 X = Target % Game.GetWidth();
+                const int32 Y = Target / Game.GetWidth();
+                if (bRecord)
+                {
+                    FMinesweeperReplayMove& Move = Replay.Moves.AddDefaulted_GetRef();
+                    Move.X = X;
+                    Move.Y = Y;
+                    Move.TimeMs = uint32(Replay.Moves.Num() - 1); // simulated games have no wall clock; one tick per move
+                }
+
+                Game.Click(X, Y, bHitBomb, Changed);
+                ++Stats.Moves;
+                if (bHitBomb) break;
+
+                Stats.Cascades[FMath::Min<int32>(FMath::FloorLog2(FMath::Max(1, Changed.Num())), NumCascadeBuckets - 1)]++;
+                if (Policy == ESimPolicy::Solver) Solver.OnTilesChanged(Changed);
+            }
+
+            ++Stats.Games;
+            if (Game.IsWon()) ++Stats.Wins;
+            if (bRecord) Replay.Encode(ReplayBytes);
+        }
+    };
+}
+
+UMinesweeperSimCommandlet::UMinesweeperSimCommandlet()
+{
+    IsClient = false;
+    IsServer = false;
+    IsEditor = false;
+    LogToConsole = true;
+}
+
+// Streams every game out of a replay file and re-drives it, reporting replay throughput
+static int32 ReplayFile(const FString& Path)
+{
+    FMinesweeperReplayReader Reader;
+    if (!Reader.Open(Path))
+    {
+        UE_LOG(LogMinesweeperSim, Error, TEXT("Could not open replay file %s"), *Path);
+        return 1;
+    }
+
+    FMinesweeperGameLogic Game;
+    FMinesweeperReplay Replay;
+    TArray<int32> Changed;
+    int64 Games = 0, Losses = 0, Moves = 0;
+
+    const double StartTime = FPlatformTime::Seconds();
+    while (Reader.Next(Replay))
+    {
+        ++Games;
+        Moves += Replay.Moves.Num();
+        if (Replay.Play(Game, Changed)) ++Losses;
+    }
+    const double Seconds = FPlatformTime::Seconds() - StartTime;
+
+    UE_LOG(LogMinesweeperSim, Display, TEXT("Replayed %lld games (%lld moves, %lld losses) at %.1f games/sec"),
+        Games, Moves, Losses, Games / FMath::Max(Seconds, 1e-9));
+    return 0;
+}
+
+int32 UMinesweeperSimCommandlet::Main(const FString& Params)
+{
+    FString ReplayIn;
+    if (FParse::Value(*Params, TEXT("ReplayIn="), ReplayIn))
+    {
+        return ReplayFile(ReplayIn);
+    }
+
+    int32 Games = 100000;
+    int32 Width = 30;
+    int32 Height = 16;
+    int32 Bombs = 99;
+    int32 Seed = 1;
+    FString PolicyName = TEXT("solver");
+    FString TopologyName = TEXT("square");
+    FString GeneratorName = TEXT("stream");
+    FParse::Value(*Params, TEXT("Games="), Games);
+    FParse::Value(*Params, TEXT("Width="), Width);
+    FParse::Value(*Params, TEXT("Height="), Height);
+    FParse::Value(*Params, TEXT("Bombs="), Bombs);
+    FParse::Value(*Params, TEXT("Seed="), Seed);
+    FParse::Value(*Params, TEXT("Policy="), PolicyName);
+    FParse::Value(*Params, TEXT("Topology="), TopologyName);
+    FParse::Value(*Params, TEXT("Generator="), GeneratorName);
+
+    FString ReplayOut;
+    FMinesweeperReplayWriter ReplayWriter;
+    FCriticalSection ReplayLock;
+    if (FParse::Value(*Params, TEXT("ReplayOut="), ReplayOut) && !ReplayWriter.Open(ReplayOut))
+    {
+        UE_LOG(LogMinesweeperSim, Error, TEXT("Could not open replay file %s"), *ReplayOut);
+        return 1;
+    }
+
+    const ESimPolicy Policy = PolicyName.Equals(TEXT("random"), ESearchCase::IgnoreCase) ? ESimPolicy::Random : ESimPolicy::Solver;
+    Games = FMath::Max(0, Games);
+
+    EMinesweeperTopology Topology = EMinesweeperTopology::Square;
+    if (TopologyName.Equals(TEXT("hex"), ESearchCase::IgnoreCase)) Topology = EMinesweeperTopology::Hex;
+    else if (TopologyName.Equals(TEXT("torus"), ESearchCase::IgnoreCase)) Topology = EMinesweeperTopology::Torus;
+    else TopologyName = TEXT("square");
+
+    EMinesweeperGenerator Generator = EMinesweeperGenerator::Stream;
+    if (GeneratorName.Equals(TEXT("counter"), ESearchCase::IgnoreCase)) Generator = EMinesweeperGenerator::Counter;
+    else GeneratorName = TEXT("stream");
+
+    const int32 NumWorkers = FMath::Max(1, FTaskGraphInterface::Get().GetNumWorkerThreads());
+    TArray<FSimWorker> Workers;
+    Workers.SetNum(NumWorkers);
+    for (FSimWorker& Worker : Workers)
+    {
+        Worker.bRecord = ReplayWriter.IsOpen();
+        Worker.Game.SetTopology(Topology);
+        Worker.Game.SetGenerator(Generator);
+    }
+
+    auto FlushReplays = [&ReplayWriter, &ReplayLock](FSimWorker& Worker)
+    {
+        FScopeLock Lock(&ReplayLock);
+        ReplayWriter.AppendEncoded(Worker.ReplayBytes);
+        Worker.ReplayBytes.Reset();
+    };
+
+    UE_LOG(LogMinesweeperSim, Display, TEXT("Simulating %d games of %dx%d %s with %d bombs (%s generator), %s policy, %d workers"),
+        Games, Width, Height, *TopologyName, Bombs, *GeneratorName, Policy == ESimPolicy::Random ? TEXT("random") : TEXT("solver"), NumWorkers);
+
+    // Workers pull game numbers from a shared counter; game N always uses seed Seed + N
+    std::atomic<int32> NextGame { 0 };
+    const double StartTime = FPlatformTime::Seconds();
+    ParallelFor(NumWorkers, [&](int32 WorkerIndex)
+    {
+        FSimWorker& Worker = Workers[WorkerIndex];
+        for (int32 GameIndex = NextGame.fetch_add(1); GameIndex < Games; GameIndex = NextGame.fetch_add(1))
+        {
+            const int32 GameSeed = int32(uint32(Seed) + uint32(GameIndex));
+            Worker.Play(Width, Height, Bombs, GameSeed == 0 ? 1 : GameSeed, Policy);
+            if (Worker.ReplayBytes.Num() >= ReplayFlushBytes) FlushReplays(Worker);
+        }
+        if (Worker.ReplayBytes.Num() > 0) FlushReplays(Worker);
+    });
+    ReplayWriter.Close();
+    const double Seconds = FPlatformTime::Seconds() - StartTime;
+
+    FSimStats Total;
+    for (const FSimWorker& Worker : Workers) Total.Merge(Worker.Stats);
+
+    const double GamesD = FMath::Max<double>(1.0, double(Total.Games));
+    UE_LOG(LogMinesweeperSim, Display, TEXT("Games: %lld  Wins: %lld  Win rate: %.2f%%"), Total.Games, Total.Wins, 100.0 * Total.Wins / GamesD);
+    UE_LOG(LogMinesweeperSim, Display, TEXT("Moves per game: %.2f"), Total.Moves / GamesD);
+    UE_LOG(LogMinesweeperSim, Display, TEXT("Throughput: %.1f games/sec (%.3f s)"), Total.Games / FMath::Max(Seconds, 1e-9), Seconds);
+
+    UE_LOG(LogMinesweeperSim, Display, TEXT("Cascade size histogram (tiles revealed per safe click):"));
+    for (int32 b = 0; b < NumCascadeBuckets; ++b)
+    {
+        if (Total.Cascades[b] == 0) continue;
+        UE_LOG(LogMinesweeperSim, Display, TEXT("  [%d, %d): %lld"), 1 << b, 1 << (b + 1), Total.Cascades[b]);
+    }
+
+    return 0;
+}
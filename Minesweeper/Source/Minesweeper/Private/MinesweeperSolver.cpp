@@ -0,0 +1,360 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "MinesweeperSolver.h"
+#include "MinesweeperGameLogic.h"
+
+namespace
+{
+    // Upper bound on search nodes per component so a pathological frontier cannot stall a move
+    constexpr int32 MaxEnumerationNodes = 1 << 20;
+
+    // Search nodes between checks of the cancel flag
+    constexpr int32 CancelCheckNodes = 1 << 10;
+}
+
+// Binds to a game and clears every deduction
+void FMinesweeperSolver::Reset(const FMinesweeperGameLogic& InGame)
+{
+    Game = &InGame;
+    Width = InGame.GetWidth();
+    Height = InGame.GetHeight();
+
+    Knowledge.Reset();
+    Knowledge.SetNumZeroed(Width * Height);
+    Constraints.Reset();
+    Dirty.Reset();
+    Touched.Reset();
+    SafeQueue.Reset();
+
+    // The scratch keeps its memory for the next game
+    Visited.Reset();
+    ComponentTileSet.Reset();
+    Seeds.Reset();
+    Stack.Reset();
+    ComponentConstraints.Reset();
+    ComponentTiles.Reset();
+    LocalIndex.Reset();
+}
+
+// Neighbours come from the game's topology, so the solver reasons over hex, torus and graph boards unchanged
+template <typename FuncType>
+void FMinesweeperSolver::ForEachNeighbour(int32 Index, FuncType&& Func) const
+{
+    Game->GetTopology().ForEachNeighbour(Index, Forward<FuncType>(Func));
+}
+
+// Updates the frontier from the tiles a click revealed
+void FMinesweeperSolver::OnTilesChanged(TArrayView<const int32> Changed)
+{
+    if (!Game || Game->IsGameOver()) return;
+
+    // Mark the whole batch first so new constraints never list a tile revealed later in the same batch
+    for (const int32 Tile : Changed)
+    {
+        Knowledge[Tile] = EKnowledge::Revealed;
+    }
+
+    for (const int32 Tile : Changed)
+    {
+        ForEachNeighbour(Tile, [this, Tile](int32 N)
+        {
+            if (FConstraint* C = Constraints.Find(N))
+            {
+                if (C->Unknowns.RemoveSingleSwap(Tile, EAllowShrinking::No) > 0)
+                {
+                    MarkDirty(N);
+                }
+            }
+        });
+
+        AddConstraint(Tile);
+    }
+}
+
+void FMinesweeperSolver::AddConstraint(int32 Tile)
+{
+    const FMSPTile& T = Game->GetByIndex(Tile);
+    if (T.bIsBomb || T.Adjacent == 0) return;
+
+    FConstraint C;
+    C.Mines = T.Adjacent;
+    ForEachNeighbour(Tile, [this, &C](int32 N)
+    {
+        if (Knowledge[N] == EKnowledge::Unknown) C.Unknowns.Add(N);
+        else if (Knowledge[N] == EKnowledge::Mine) --C.Mines;
+    });
+
+    if (C.Unknowns.Num() > 0)
+    {
+        Constraints.Add(Tile, MoveTemp(C));
+        MarkDirty(Tile);
+    }
+}
+
+void FMinesweeperSolver::MarkDirty(int32 ConstraintTile)
+{
+    FConstraint& C = Constraints[ConstraintTile];
+    if (!C.bDirty)
+    {
+        C.bDirty = true;
+        Dirty.Add(ConstraintTile);
+    }
+    Touched.Add(ConstraintTile);
+}
+
+void FMinesweeperSolver::Resolve(int32 Tile, EKnowledge Result)
+{
+    if (Knowledge[Tile] != EKnowledge::Unknown) return;
+
+    Knowledge[Tile] = Result;
+    if (Result == EKnowledge::Safe)
+    {
+        SafeQueue.Add(Tile);
+    }
+
+    ForEachNeighbour(Tile, [this, Tile, Result](int32 N)
+    {
+        if (FConstraint* C = Constraints.Find(N))
+        {
+            if (C->Unknowns.RemoveSingleSwap(Tile, EAllowShrinking::No) > 0)
+            {
+                if (Result == EKnowledge::Mine) --C->Mines;
+                MarkDirty(N);
+            }
+        }
+    });
+}
+
+bool FMinesweeperSolver::ApplySingleRules(int32 ConstraintTile)
+{
+    const FConstraint& C = Constraints[ConstraintTile];
+    EKnowledge Result;
+    if (C.Mines == 0) Result = EKnowledge::Safe;
+    else if (C.Mines == C.Unknowns.Num()) Result = EKnowledge::Mine;
+    else return false;
+
+    // Resolve edits C.Unknowns, so walk a copy
+    const TArray<int32, TInlineAllocator<8>> Tiles = C.Unknowns;
+    for (const int32 Tile : Tiles)
+    {
+        Resolve(Tile, Result);
+    }
+    return true;
+}
+
+bool FMinesweeperSolver::ApplyPairRules(int32 ConstraintTile)
+{
+    TArray<int32, TInlineAllocator<16>> Partners;
+    for (const int32 U : Constraints[ConstraintTile].Unknowns)
+    {
+        ForEachNeighbour(U, [this, ConstraintTile, &Partners](int32 N)
+        {
+            if (N != ConstraintTile && Constraints.Contains(N)) Partners.AddUnique(N);
+        });
+    }
+
+    for (const int32 Partner : Partners)
+    {
+        const FConstraint& A = Constraints[ConstraintTile];
+        const FConstraint& B = Constraints[Partner];
+
+        TArray<int32, TInlineAllocator<8>> OnlyA, OnlyB;
+        for (const int32 U : A.Unknowns) if (!B.Unknowns.Contains(U)) OnlyA.Add(U);
+        for (const int32 U : B.Unknowns) if (!A.Unknowns.Contains(U)) OnlyB.Add(U);
+
+        // mines(OnlyB) - mines(OnlyA) = B.Mines - A.Mines; when that equals |OnlyB| both sides are forced
+        TArray<int32, TInlineAllocator<8>>* Mines = nullptr;
+        TArray<int32, TInlineAllocator<8>>* Safes = nullptr;
+        if (B.Mines - A.Mines == OnlyB.Num()) { Mines = &OnlyB; Safes = &OnlyA; }
+        else if (A.Mines - B.Mines == OnlyA.Num()) { Mines = &OnlyA; Safes = &OnlyB; }
+
+        if (Mines && (Mines->Num() > 0 || Safes->Num() > 0))
+        {
+            for (const int32 Tile : *Mines) Resolve(Tile, EKnowledge::Mine);
+            for (const int32 Tile : *Safes) Resolve(Tile, EKnowledge::Safe);
+            return true;
+        }
+    }
+    return false;
+}
+
+// Stops early on cancel; the dirty constraints left over are picked up by the next call
+void FMinesweeperSolver::Propagate()
+{
+    while (Dirty.Num() > 0 && !IsCancelled())
+    {
+        const int32 Tile = Dirty.Pop(EAllowShrinking::No);
+        FConstraint* C = Constraints.Find(Tile);
+        if (!C) continue;
+        C->bDirty = false;
+
+        if (C->Unknowns.Num() == 0)
+        {
+            Constraints.Remove(Tile);
+            continue;
+        }
+
+        if (!ApplySingleRules(Tile))
+        {
+            ApplyPairRules(Tile);
+        }
+    }
+}
+
+// Propagates rules, then searches the components touched since the last call that the rules could not finish
+void FMinesweeperSolver::Solve()
+{
+    if (!Game) return;
+
+    bool bProgress = true;
+    while (bProgress && !IsCancelled())
+    {
+        Propagate();
+
+        bProgress = false;
+        Visited.Reset();
+        Seeds.Reset();
+        for (const int32 Tile : Touched) Seeds.Add(Tile);
+        Touched.Reset();
+
+        for (const int32 Seed : Seeds)
+        {
+            if (IsCancelled()) return;
+            if (Visited.Contains(Seed) || !Constraints.Contains(Seed)) continue;
+
+            ComponentConstraints.Reset();
+            ComponentTiles.Reset();
+            CollectComponent(Seed, ComponentConstraints, ComponentTiles);
+            if (ComponentTiles.Num() <= MaxEnumerationTiles && SolveComponent(ComponentConstraints, ComponentTiles))
+            {
+                bProgress = true;
+            }
+        }
+    }
+}
+
+// Depth-first over constraints with an explicit stack; a constraint's tiles are listed together as it is reached
+void FMinesweeperSolver::CollectComponent(int32 Seed, TArray<int32>& OutConstraints, TArray<int32>& OutTiles)
+{
+    ComponentTileSet.Reset();
+    Stack.Reset();
+    Stack.Add(Seed);
+    Visited.Add(Seed);
+
+    while (Stack.Num() > 0)
+    {
+        const int32 CTile = Stack.Pop(EAllowShrinking::No);
+        OutConstraints.Add(CTile);
+
+        for (const int32 U : Constraints[CTile].Unknowns)
+        {
+            bool bAlreadyInSet = false;
+            ComponentTileSet.Add(U, &bAlreadyInSet);
+            if (bAlreadyInSet) continue;
+
+            OutTiles.Add(U);
+            ForEachNeighbour(U, [this](int32 N)
+            {
+                if (!Visited.Contains(N) && Constraints.Contains(N))
+                {
+                    Visited.Add(N);
+                    Stack.Add(N);
+                }
+            });
+        }
+    }
+}
+
+bool FMinesweeperSolver::SolveComponent(const TArray<int32>& InConstraints, const TArray<int32>& InTiles)
+{
+    const int32 NumTiles = InTiles.Num();
+    const int32 NumConstraints = InConstraints.Num();
+    if (NumTiles == 0) return false;
+
+    LocalIndex.Reset();
+    for (int32 i = 0; i < NumTiles; ++i) LocalIndex.Add(InTiles[i], i);
+
+    // Per constraint: target mines and how many of its tiles are still unassigned; per tile: its constraints
+    Target.SetNumUninitialized(NumConstraints, EAllowShrinking::No);
+    Assigned.Reset();
+    Assigned.SetNumZeroed(NumConstraints, EAllowShrinking::No);
+    Remaining.SetNumUninitialized(NumConstraints, EAllowShrinking::No);
+    if (TileConstraints.Num() < NumTiles) TileConstraints.SetNum(NumTiles);
+    for (int32 i = 0; i < NumTiles; ++i) TileConstraints[i].Reset();
+    for (int32 c = 0; c < NumConstraints; ++c)
+    {
+        const FConstraint& C = Constraints[InConstraints[c]];
+        Target[c] = C.Mines;
+        Remaining[c] = C.Unknowns.Num();
+        for (const int32 U : C.Unknowns) TileConstraints[LocalIndex[U]].Add(c);
+    }
+
+    // Tiles were collected depth-first, a constraint's tiles together, so constraints close early and prune well
+    uint32 EverMine = 0, EverSafe = 0, Current = 0;
+    int32 Nodes = 0;
+    bool bAborted = false;
+
+    // Recursion through a generic lambda that is handed itself, so the calls bind statically rather than through a TFunction
+    auto Assign = [&](auto& Self, int32 i) -> void
+    {
+        if (bAborted) return;
+        if (++Nodes > MaxEnumerationNodes || (Nodes % CancelCheckNodes == 0 && IsCancelled())) { bAborted = true; return; }
+
+        if (i == NumTiles)
+        {
+            EverMine |= Current;
+            EverSafe |= ~Current;
+            return;
+        }
+
+        for (int32 bMine = 0; bMine <= 1; ++bMine)
+        {
+            bool bConsistent = true;
+            for (const int32 c : TileConstraints[i])
+            {
+                Assigned[c] += bMine;
+                --Remaining[c];
+                bConsistent &= Assigned[c] <= Target[c] && Assigned[c] + Remaining[c] >= Target[c];
+            }
+            if (bConsistent)
+            {
+                if (bMine) Current |= 1u << i;
+                Self(Self, i + 1);
+                Current &= ~(1u << i);
+            }
+            for (const int32 c : TileConstraints[i])
+            {
+                Assigned[c] -= bMine;
+                ++Remaining[c];
+            }
+        }
+    };
+    Assign(Assign, 0);
+
+    if (bAborted || (EverMine | EverSafe) == 0) return false;
+
+    bool bProgress = false;
+    for (int32 i = 0; i < NumTiles; ++i)
+    {
+        const uint32 Bit = 1u << i;
+        if (!(EverMine & Bit)) { Resolve(InTiles[i], EKnowledge::Safe); bProgress = true; }
+        else if (!(EverSafe & Bit)) { Resolve(InTiles[i], EKnowledge::Mine); bProgress = true; }
+    }
+    return bProgress;
+}
+
+// Hands out deduced-safe tiles newest first, skipping any the player has revealed meanwhile
+bool FMinesweeperSolver::PopSafeTile(int32& OutIndex)
+{
+    while (SafeQueue.Num() > 0)
+    {
+        const int32 Tile = SafeQueue.Pop(EAllowShrinking::No);
+        if (Knowledge[Tile] == EKnowledge::Safe)
+        {
+            OutIndex = Tile;
+            return true;
+        }
+    }
+    return false;
+}
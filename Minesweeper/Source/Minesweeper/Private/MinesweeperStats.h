@@ -0,0 +1,14 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "Stats/Stats.h"
+#include "ProfilingDebugging/CpuProfilerTrace.h"
+
+// `stat Minesweeper` in the editor; the same scopes also show up as CPU events in Unreal Insights
+DECLARE_STATS_GROUP(TEXT("Minesweeper"), STATGROUP_Minesweeper, STATCAT_Advanced);
+
+// Cycle stat plus a matching Insights CPU event for the enclosing scope
+#define MINESWEEPER_SCOPE(Name, Stat) \
+	TRACE_CPUPROFILER_EVENT_SCOPE(Name); \
+	SCOPE_CYCLE_COUNTER(Stat)
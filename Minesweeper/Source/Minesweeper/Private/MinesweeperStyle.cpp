@@ -52,12 +52,25 @@ TSharedRef<FSlateStyleSet> FMinesweeperStyle::Create()
 
 	// Define the Minesweeper icon with a brush
 	Style->Set("Minesweeper.Icon", new FSlateImageBrush(IconPath, FVector2D(96.0f, 96.0f)));
+
+	// Pre-rendered tile faces, numbers, bomb and flag in one strip of 64x64 cells
+	FString AtlasPath = FPaths::Combine(IPluginManager::Get().FindPlugin("MinesweeperTool")->GetBaseDir(), TEXT("Resources/MinesweeperTileAtlas.png"));
+	Style->Set("Minesweeper.TileAtlas", new FSlateImageBrush(AtlasPath, FVector2D(64.0f * TileAtlasCells, 64.0f)));
 	
 
 	return Style;
 }
 
 
+// Crops the atlas brush to one cell through its UV region
+FSlateBrush FMinesweeperStyle::MakeTileAtlasCell(int32 Cell)
+{
+	FSlateBrush Brush = *Get().GetBrush("Minesweeper.TileAtlas");
+	Brush.ImageSize = FVector2D(64.0f, 64.0f);
+	Brush.SetUVRegion(FBox2f(FVector2f(float(Cell) / TileAtlasCells, 0.0f), FVector2f(float(Cell + 1) / TileAtlasCells, 1.0f)));
+	return Brush;
+}
+
 void FMinesweeperStyle::ReloadTextures()
 {
 	if (FSlateApplication::IsInitialized())
@@ -0,0 +1,149 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "MinesweeperTopology.h"
+
+// Checks the table is a well-formed symmetric graph before taking it over
+bool FMinesweeperTopology::MakeGraph(int32 W, int32 H, TArray<int32> InOffsets, TArray<int32> InNeighbours, FMinesweeperTopology& Out)
+{
+    if (W < 1 || H < 1 || int64(W) * H > MAX_int32 - 1) return false;
+
+    const int32 NumTiles = W * H;
+    if (InOffsets.Num() != NumTiles + 1 || InOffsets[0] != 0 || InOffsets[NumTiles] != InNeighbours.Num()) return false;
+
+    // Offsets first, so every slice below is in range
+    for (int32 i = 0; i < NumTiles; ++i)
+    {
+        const int32 Degree = InOffsets[i + 1] - InOffsets[i];
+        if (Degree < 0 || Degree > MaxDegree) return false;
+    }
+
+    for (int32 i = 0; i < NumTiles; ++i)
+    {
+        const int32 Degree = InOffsets[i + 1] - InOffsets[i];
+        const TArrayView<const int32> Slice(InNeighbours.GetData() + InOffsets[i], Degree);
+        for (int32 n = 0; n < Degree; ++n)
+        {
+            const int32 j = Slice[n];
+            if (j < 0 || j >= NumTiles || j == i) return false;
+            if (MakeArrayView(Slice.GetData(), n).Contains(j)) return false;
+
+            // Every edge must be listed from both ends, or a number would count tiles that do not count it back
+            const TArrayView<const int32> Back(InNeighbours.GetData() + InOffsets[j], InOffsets[j + 1] - InOffsets[j]);
+            if (!Back.Contains(i)) return false;
+        }
+    }
+
+    TSharedRef<FTable, ESPMode::ThreadSafe> NewTable = MakeShared<FTable, ESPMode::ThreadSafe>();
+    NewTable->Offsets = MoveTemp(InOffsets);
+    NewTable->Neighbours = MoveTemp(InNeighbours);
+
+    Out.Kind = EMinesweeperTopology::Graph;
+    Out.Width = W;
+    Out.Height = H;
+    Out.Table = NewTable;
+    return true;
+}
+
+// Off-board coordinates are dropped
+template <typename FuncType>
+void FMinesweeperTopology::BuildTable(FuncType&& TileNeighbours)
+{
+    const int32 NumTiles = Width * Height;
+    TSharedRef<FTable, ESPMode::ThreadSafe> NewTable = MakeShared<FTable, ESPMode::ThreadSafe>();
+    TArray<int32>& Offsets = NewTable->Offsets;
+    TArray<int32>& Neighbours = NewTable->Neighbours;
+    Offsets.SetNumUninitialized(NumTiles + 1);
+    Neighbours.Reserve(NumTiles * MaxDegree);
+
+    for (int32 i = 0; i < NumTiles; ++i)
+    {
+        Offsets[i] = Neighbours.Num();
+        TileNeighbours(i % Width, i / Width, [this, &Neighbours](int32 nx, int32 ny)
+        {
+            if (nx >= 0 && nx < Width && ny >= 0 && ny < Height) Neighbours.Add(ny * Width + nx);
+        });
+    }
+    Offsets[NumTiles] = Neighbours.Num();
+    Table = NewTable;
+}
+
+// Built-in tables are generated per board size; a table already built for this size is kept,
+// so repeated NewGames on one size, and no-guess candidates sharing it, pay for it once
+void FMinesweeperTopology::Build(int32 W, int32 H)
+{
+    if (Kind == EMinesweeperTopology::Graph) return;
+
+    W = FMath::Max(1, W);
+    H = FMath::Max(1, H);
+    if (W == Width && H == Height && (!HasTable() || Table.IsValid())) return;
+
+    Width = W;
+    Height = H;
+    Table.Reset();
+
+    switch (Kind)
+    {
+    case EMinesweeperTopology::Hex:
+        BuildTable([](int32 X, int32 Y, auto&& Add)
+        {
+            // Odd rows sit half a tile right, so their neighbours above and below are one column further right
+            const int32 Shift = Y & 1;
+            Add(X - 1, Y);
+            Add(X + 1, Y);
+            Add(X - 1 + Shift, Y - 1);
+            Add(X + Shift, Y - 1);
+            Add(X - 1 + Shift, Y + 1);
+            Add(X + Shift, Y + 1);
+        });
+        break;
+
+    default:
+        break;
+    }
+}
+
+void FMinesweeperTopology::Serialize(FArchive& Ar)
+{
+    uint8 SavedKind = uint8(Kind);
+    Ar << SavedKind;
+    if (Ar.IsLoading())
+    {
+        if (SavedKind > uint8(EMinesweeperTopology::Graph))
+        {
+            Ar.SetError();
+            return;
+        }
+        // A table built for another kind must not survive Build's same-size shortcut
+        if (EMinesweeperTopology(SavedKind) != Kind)
+        {
+            Table.Reset();
+            Width = 0;
+            Height = 0;
+        }
+        Kind = EMinesweeperTopology(SavedKind);
+    }
+    if (Kind != EMinesweeperTopology::Graph) return;
+
+    if (Ar.IsSaving())
+    {
+        // The table is shared and never written once built, so it is saved from a copy
+        TArray<int32> SavedOffsets = Table->Offsets;
+        TArray<int32> SavedNeighbours = Table->Neighbours;
+        Ar << Width << Height;
+        SavedOffsets.BulkSerialize(Ar);
+        SavedNeighbours.BulkSerialize(Ar);
+        return;
+    }
+
+    int32 W = 0, H = 0;
+    TArray<int32> LoadedOffsets, LoadedNeighbours;
+    Ar << W << H;
+    LoadedOffsets.BulkSerialize(Ar);
+    LoadedNeighbours.BulkSerialize(Ar);
+    if (Ar.IsError() || !MakeGraph(W, H, MoveTemp(LoadedOffsets), MoveTemp(LoadedNeighbours), *this))
+    {
+        *this = FMinesweeperTopology();
+        Ar.SetError();
+    }
+}
@@ -0,0 +1,48 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+// LEB128 varints shared by the replay and save formats
+namespace MinesweeperVarInt
+{
+    template <typename AllocatorType>
+    void WriteUInt(TArray<uint8, AllocatorType>& Out, uint32 Value)
+    {
+        while (Value >= 0x80)
+        {
+            Out.Add(uint8(Value | 0x80));
+            Value >>= 7;
+        }
+        Out.Add(uint8(Value));
+    }
+
+    template <typename AllocatorType>
+    void WriteInt(TArray<uint8, AllocatorType>& Out, int32 Value)
+    {
+        // Zigzag so small negative values stay small
+        WriteUInt(Out, (uint32(Value) << 1) ^ uint32(Value >> 31));
+    }
+
+    inline bool ReadUInt(TArrayView<const uint8> Data, int32& Pos, uint32& OutValue)
+    {
+        OutValue = 0;
+        for (int32 Shift = 0; Shift < 35; Shift += 7)
+        {
+            if (Pos >= Data.Num()) return false;
+            const uint8 Byte = Data[Pos++];
+            OutValue |= uint32(Byte & 0x7F) << Shift;
+            if (!(Byte & 0x80)) return true;
+        }
+        return false;
+    }
+
+    inline bool ReadInt(TArrayView<const uint8> Data, int32& Pos, int32& OutValue)
+    {
+        uint32 Raw = 0;
+        if (!ReadUInt(Data, Pos, Raw)) return false;
+        OutValue = int32(Raw >> 1) ^ -int32(Raw & 1);
+        return true;
+    }
+}
@@ -0,0 +1,319 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Slate/SMinesweeperBoard.h"
+#include "MinesweeperGameLogic.h"
+#include "MinesweeperChunkedBoard.h"
+#include "MinesweeperStats.h"
+#include "MinesweeperTopology.h"
+#include "Rendering/DrawElements.h"
+
+DECLARE_CYCLE_STAT(TEXT("Paint board"), STAT_MinesweeperPaintBoard, STATGROUP_Minesweeper);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Tiles painted"), STAT_MinesweeperTilesPainted, STATGROUP_Minesweeper);
+DECLARE_FLOAT_ACCUMULATOR_STAT(TEXT("Click to repaint (ms)"), STAT_MinesweeperClickToPaintMs, STATGROUP_Minesweeper);
+
+// Tile colours
+static const FLinearColor kHiddenTileColor(0.52f, 0.52f, 0.56f, 1.f); // multiplies the atlas face shading
+static const FLinearColor kRevealedTileColor(0.12f, 0.12f, 0.13f, 1.f);
+static const FLinearColor kBombTileColor(0.55f, 0.08f, 0.08f, 1.f);
+
+// Heatmap ends, blended over hidden tiles from safe to certain mine
+static const FLinearColor kSafeHeatColor(0.1f, 0.8f, 0.2f, 0.45f);
+static const FLinearColor kMineHeatColor(0.9f, 0.1f, 0.1f, 0.45f);
+
+// A revealed count is drawn straight from its atlas cell
+static_assert(FMinesweeperTopology::MaxDegree < FMinesweeperStyle::TileAtlasBomb, "Adjacency counts must map to the number cells of the atlas");
+
+void SMinesweeperBoard::Construct(const FArguments& InArgs)
+{
+    Game = InArgs._Game;
+    Endless = InArgs._Endless;
+    TileSize = InArgs._TileSize;
+    TilePadding = InArgs._TilePadding;
+    OnTileClicked = InArgs._OnTileClicked;
+    OnTileFlagged = InArgs._OnTileFlagged;
+    OnViewChanged = InArgs._OnViewChanged;
+
+    for (int32 Cell = 0; Cell < FMinesweeperStyle::TileAtlasUsedCells; ++Cell)
+    {
+        AtlasCells[Cell] = FMinesweeperStyle::MakeTileAtlasCell(Cell);
+    }
+
+    // Tiles partly scrolled out of the viewport must not draw over neighbouring widgets
+    SetClipping(EWidgetClipping::ClipToBounds);
+}
+
+void SMinesweeperBoard::RefreshBoard()
+{
+    ViewOffset = FVector2D::ZeroVector;
+    PaintedTiles = FIntRect();
+    Invalidate(EInvalidateWidgetReason::Layout);
+}
+
+// A leaf widget repaints whole, so the saving is in skipping the repaint when every changed tile is out of view
+void SMinesweeperBoard::RefreshTiles(TArrayView<const int32> Changed)
+{
+    if (!Game || IsEndless()) return;
+
+    const int32 W = Game->GetWidth();
+    for (const int32 Index : Changed)
+    {
+        if (IsTilePainted(FIntPoint(Index % W, Index / W)))
+        {
+            Invalidate(EInvalidateWidgetReason::Paint);
+            return;
+        }
+    }
+}
+
+void SMinesweeperBoard::RefreshTiles(TArrayView<const FIntPoint> Changed)
+{
+    for (const FIntPoint& Tile : Changed)
+    {
+        if (IsTilePainted(Tile))
+        {
+            Invalidate(EInvalidateWidgetReason::Paint);
+            return;
+        }
+    }
+}
+
+// Before the first paint nothing is known to be out of view
+bool SMinesweeperBoard::IsTilePainted(const FIntPoint& Tile) const
+{
+    return PaintedTiles.IsEmpty() || PaintedTiles.Contains(Tile);
+}
+
+void SMinesweeperBoard::RefreshView()
+{
+    Invalidate(EInvalidateWidgetReason::Paint);
+}
+
+void SMinesweeperBoard::SetEndless(bool bInEndless)
+{
+    bEndless = bInEndless;
+    ReportedView = FIntRect();
+    PaintedTiles = FIntRect();
+    if (bEndless)
+    {
+        Probabilities.Reset();
+    }
+}
+
+void SMinesweeperBoard::SetProbabilities(TArray<float>&& InProbabilities)
+{
+    if (Probabilities.Num() == 0 && InProbabilities.Num() == 0) return;
+
+    Probabilities = MoveTemp(InProbabilities);
+    Invalidate(EInvalidateWidgetReason::Paint);
+}
+
+// Small boards ask for their full size; big ones just ask for a reasonable viewport and get panned
+FVector2D SMinesweeperBoard::ComputeDesiredSize(float) const
+{
+    if (IsEndless()) return FVector2D(1024.f, 768.f);
+    if (!Game) return FVector2D::ZeroVector;
+    return FVector2D::Min(GetBoardExtent() * Zoom, FVector2D(1024.f, 768.f));
+}
+
+// Rows are laid out straight for every topology except hex; the neighbour table decides what touches what
+float SMinesweeperBoard::GetRowShift(int32 Y) const
+{
+    return Game && !IsEndless() && Game->GetTopology().GetKind() == EMinesweeperTopology::Hex && (Y & 1) ? GetPitch() * 0.5f : 0.f;
+}
+
+FVector2D SMinesweeperBoard::GetBoardExtent() const
+{
+    if (!Game || IsEndless()) return FVector2D::ZeroVector;
+    const float ShiftedWidth = Game->GetHeight() > 1 ? GetRowShift(1) : 0.f;
+    return FVector2D(Game->GetWidth() * GetPitch() + ShiftedWidth, Game->GetHeight() * GetPitch());
+}
+
+FIntRect SMinesweeperBoard::GetVisibleTiles(const FVector2D& ViewSize) const
+{
+    const double Pitch = GetPitch();
+    const FVector2D BoardViewSize = ViewSize / Zoom;
+    FIntRect Tiles(
+        FMath::FloorToInt((ViewOffset.X - GetRowShift(1)) / Pitch),
+        FMath::FloorToInt(ViewOffset.Y / Pitch),
+        FMath::FloorToInt((ViewOffset.X + BoardViewSize.X) / Pitch) + 1,
+        FMath::FloorToInt((ViewOffset.Y + BoardViewSize.Y) / Pitch) + 1);
+    if (!IsEndless() && Game)
+    {
+        Tiles.Clip(FIntRect(0, 0, Game->GetWidth(), Game->GetHeight()));
+    }
+    return Tiles;
+}
+
+bool SMinesweeperBoard::TileFromLocalPosition(const FVector2D& LocalPos, int32& OutX, int32& OutY) const
+{
+    if (!Game && !IsEndless()) return false;
+
+    const FVector2D BoardPos = LocalPos / Zoom + ViewOffset;
+    const float Pitch = GetPitch();
+    OutY = FMath::FloorToInt(BoardPos.Y / Pitch);
+    const float RowX = BoardPos.X - GetRowShift(OutY);
+    OutX = FMath::FloorToInt(RowX / Pitch);
+    if (IsEndless() ? !FMinesweeperChunkedBoard::IsValid(OutX, OutY) : !Game->IsValid(OutX, OutY)) return false;
+
+    // Ignore clicks that land in the padding between tiles
+    const float InX = RowX - OutX * Pitch;
+    const float InY = BoardPos.Y - OutY * Pitch;
+    return InX >= TilePadding && InX < TilePadding + TileSize
+        && InY >= TilePadding && InY < TilePadding + TileSize;
+}
+
+void SMinesweeperBoard::ClampView(const FVector2D& ViewSize)
+{
+    if (IsEndless())
+    {
+        const double Limit = double(FMinesweeperChunkedBoard::MaxCoord / 2) * GetPitch();
+        ViewOffset = FVector2D(FMath::Clamp(ViewOffset.X, -Limit, Limit), FMath::Clamp(ViewOffset.Y, -Limit, Limit));
+        return;
+    }
+    const FVector2D MaxOffset = FVector2D::Max(FVector2D::ZeroVector, GetBoardExtent() - ViewSize / Zoom);
+    ViewOffset = FVector2D::Max(FVector2D::ZeroVector, FVector2D::Min(ViewOffset, MaxOffset));
+}
+
+FReply SMinesweeperBoard::OnMouseButtonDown(const FGeometry& MyGeometry, const FPointerEvent& MouseEvent)
+{
+    const FKey Button = MouseEvent.GetEffectingButton();
+    if (Button == EKeys::MiddleMouseButton)
+    {
+        bPanning = true;
+        return FReply::Handled().CaptureMouse(SharedThis(this));
+    }
+
+    if (Button != EKeys::LeftMouseButton && Button != EKeys::RightMouseButton)
+    {
+        return FReply::Unhandled();
+    }
+
+    int32 X = 0, Y = 0;
+    if (TileFromLocalPosition(MyGeometry.AbsoluteToLocal(MouseEvent.GetScreenSpacePosition()), X, Y))
+    {
+        PendingClickTime = FPlatformTime::Seconds();
+        (Button == EKeys::LeftMouseButton ? OnTileClicked : OnTileFlagged).ExecuteIfBound(X, Y);
+    }
+    return FReply::Handled();
+}
+
+FReply SMinesweeperBoard::OnMouseButtonUp(const FGeometry& MyGeometry, const FPointerEvent& MouseEvent)
+{
+    if (bPanning && MouseEvent.GetEffectingButton() == EKeys::MiddleMouseButton)
+    {
+        bPanning = false;
+        return FReply::Handled().ReleaseMouseCapture();
+    }
+    return FReply::Unhandled();
+}
+
+// Drags the board with the cursor while the middle button is held
+FReply SMinesweeperBoard::OnMouseMove(const FGeometry& MyGeometry, const FPointerEvent& MouseEvent)
+{
+    if (!bPanning || !HasMouseCapture()) return FReply::Unhandled();
+
+    ViewOffset -= MouseEvent.GetCursorDelta() / (MyGeometry.Scale * Zoom);
+    ClampView(MyGeometry.GetLocalSize());
+    Invalidate(EInvalidateWidgetReason::Paint);
+    return FReply::Handled();
+}
+
+// Zooms about the cursor, so the tile under it stays put
+FReply SMinesweeperBoard::OnMouseWheel(const FGeometry& MyGeometry, const FPointerEvent& MouseEvent)
+{
+    const FVector2D LocalPos = MyGeometry.AbsoluteToLocal(MouseEvent.GetScreenSpacePosition());
+    const FVector2D BoardPos = LocalPos / Zoom + ViewOffset;
+
+    Zoom = FMath::Clamp(Zoom * FMath::Pow(1.15f, MouseEvent.GetWheelDelta()), MinZoom, MaxZoom);
+    ViewOffset = BoardPos - LocalPos / Zoom;
+    ClampView(MyGeometry.GetLocalSize());
+    Invalidate(EInvalidateWidgetReason::Layout);
+    return FReply::Handled();
+}
+
+// Reports the endless tiles in view before they are painted, so the owner can page their chunks in first
+void SMinesweeperBoard::Tick(const FGeometry& AllottedGeometry, const double InCurrentTime, const float InDeltaTime)
+{
+    if (!IsEndless()) return;
+
+    const FIntRect Tiles = GetVisibleTiles(AllottedGeometry.GetLocalSize());
+    if (Tiles != ReportedView)
+    {
+        ReportedView = Tiles;
+        OnViewChanged.ExecuteIfBound(Tiles);
+    }
+}
+
+int32 SMinesweeperBoard::OnPaint(const FPaintArgs& Args, const FGeometry& AllottedGeometry, const FSlateRect& MyCullingRect, FSlateWindowElementList& OutDrawElements, int32 LayerId, const FWidgetStyle& InWidgetStyle, bool bParentEnabled) const
+{
+    MINESWEEPER_SCOPE(Minesweeper_PaintBoard, STAT_MinesweeperPaintBoard);
+    const bool bDrawEndless = IsEndless();
+    if (!Game && !bDrawEndless) return LayerId;
+
+    // Only the tile range under the viewport is visited, so the cost follows the viewport size, not the board size
+    const double Pitch = GetPitch();
+    const FIntRect Visible = GetVisibleTiles(AllottedGeometry.GetLocalSize());
+    PaintedTiles = Visible;
+    const int32 MinX = Visible.Min.X;
+    const int32 MinY = Visible.Min.Y;
+    const int32 MaxX = Visible.Max.X - 1;
+    const int32 MaxY = Visible.Max.Y - 1;
+    const FVector2D TileExtent(TileSize * Zoom, TileSize * Zoom);
+
+    // Glyphs are unreadable below a few pixels, so zoomed far out only the tile colours are drawn
+    const bool bDrawGlyphs = TileExtent.X >= 6.f;
+    const FLinearColor StyleTint = InWidgetStyle.GetColorAndOpacityTint();
+    const bool bDrawHeat = !bDrawEndless && Probabilities.Num() == Game->GetWidth() * Game->GetHeight();
+
+    // Every box is a cell of the same atlas texture; backgrounds go on one layer and glyphs on the next so each pass batches
+    const int32 BoxLayer = LayerId;
+    const int32 GlyphLayer = LayerId + 1;
+
+    for (int32 y = MinY; y <= MaxY; ++y)
+    {
+        const float RowShift = GetRowShift(y);
+        for (int32 x = MinX; x <= MaxX; ++x)
+        {
+            // Endless coordinates run far past float precision, so positions are worked out in doubles
+            const FMSPTile T = bDrawEndless ? Endless->Get(x, y) : Game->Get(x, y);
+            const FVector2D Origin = (FVector2D(x * Pitch + TilePadding + RowShift, y * Pitch + TilePadding) - ViewOffset) * Zoom;
+            const FPaintGeometry TileGeometry = AllottedGeometry.ToPaintGeometry(TileExtent, FSlateLayoutTransform(Origin));
+
+            int32 Glyph = 0;
+            if (!T.bRevealed)
+            {
+                FSlateDrawElement::MakeBox(OutDrawElements, BoxLayer, TileGeometry,
+                    &AtlasCells[FMinesweeperStyle::TileAtlasHidden], ESlateDrawEffect::None, kHiddenTileColor * StyleTint);
+                Glyph = T.bFlagged ? FMinesweeperStyle::TileAtlasFlag : 0;
+
+                // Drawn with the glyphs so it stays one batch; a flag already says what the player thinks
+                const float Chance = bDrawHeat && Glyph == 0 ? Probabilities[y * Game->GetWidth() + x] : -1.f;
+                if (Chance >= 0.f)
+                {
+                    FSlateDrawElement::MakeBox(OutDrawElements, GlyphLayer, TileGeometry,
+                        &AtlasCells[FMinesweeperStyle::TileAtlasSolid], ESlateDrawEffect::None, FMath::Lerp(kSafeHeatColor, kMineHeatColor, Chance) * StyleTint);
+                }
+            }
+            else
+            {
+                FSlateDrawElement::MakeBox(OutDrawElements, BoxLayer, TileGeometry,
+                    &AtlasCells[FMinesweeperStyle::TileAtlasSolid], ESlateDrawEffect::None, (T.bIsBomb ? kBombTileColor : kRevealedTileColor) * StyleTint);
+                Glyph = T.bIsBomb ? FMinesweeperStyle::TileAtlasBomb : T.Adjacent;
+            }
+            if (Glyph == 0 || !bDrawGlyphs) continue;
+
+            // Number colours are baked into the atlas
+            FSlateDrawElement::MakeBox(OutDrawElements, GlyphLayer, TileGeometry,
+                &AtlasCells[Glyph], ESlateDrawEffect::None, StyleTint);
+        }
+    }
+
+    SET_DWORD_STAT(STAT_MinesweeperTilesPainted, FMath::Max(0, MaxX - MinX + 1) * FMath::Max(0, MaxY - MinY + 1));
+    if (PendingClickTime > 0.0)
+    {
+        SET_FLOAT_STAT(STAT_MinesweeperClickToPaintMs, float((FPlatformTime::Seconds() - PendingClickTime) * 1000.0));
+        PendingClickTime = 0.0;
+    }
+
+    return GlyphLayer;
+}
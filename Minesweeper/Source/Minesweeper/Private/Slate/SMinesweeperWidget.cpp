@@ -2,16 +2,22 @@
 
 #include "Slate/SMinesweeperWidget.h"
 #include "SlateOptMacros.h"
-#include "Widgets/Layout/SScrollBox.h"
 #include "Widgets/Layout/SBox.h"
 #include "Widgets/Input/SSpinBox.h"
 #include "Widgets/Input/SButton.h"
-#include "Widgets/Layout/SGridPanel.h"
+#include "Widgets/Input/SCheckBox.h"
 #include "Widgets/Text/STextBlock.h"
-#include "Framework/Application/SlateApplication.h"
-#include "Widgets/Layout/SScaleBox.h"
+#include "Slate/SMinesweeperBoard.h"
+#include "MinesweeperStats.h"
 #include "Misc/MessageDialog.h"
-#include "GenericPlatform/GenericApplication.h" // FDisplayMetrics
+#include "Misc/Paths.h"
+#include "HAL/FileManager.h"
+#include "Tasks/Task.h"
+
+DECLARE_CYCLE_STAT(TEXT("BuildBoard"), STAT_MinesweeperBuildBoard, STATGROUP_Minesweeper);
+DECLARE_CYCLE_STAT(TEXT("RebuildGrid"), STAT_MinesweeperRebuildGrid, STATGROUP_Minesweeper);
+DECLARE_CYCLE_STAT(TEXT("ApplyQueuedInput"), STAT_MinesweeperApplyQueuedInput, STATGROUP_Minesweeper);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Widgets created (last rebuild)"), STAT_MinesweeperWidgetsCreated, STATGROUP_Minesweeper);
 
 #define LOCTEXT_NAMESPACE "SMinesweeperWidget"
 
@@ -19,9 +25,30 @@
 static constexpr float kTilePx  = 24.f; // per-tile square content
 static constexpr float kSlotPad = 1.f;  // grid slot padding
 
+// The board view only paints what is on screen, so the side limit is about memory, not screen size; endless games have no sides
+static constexpr int32 kMaxGridSide = FMinesweeperGameLogic::MaxSide;
+
+// Where the in-progress game is kept while the tab is closed
+static FString GetSavedGamePath()
+{
+    return FPaths::Combine(FPaths::ProjectSavedDir(), TEXT("Minesweeper"), TEXT("CurrentGame.sav"));
+}
+
 void SMinesweeperWidget::Construct(const FArguments& InArgs)
 {
-    Game.NewGame(GridW, GridH, Bombs);
+    // Pick up the game left open last time; the board below is built straight from it, no rebuild needed
+    if (LoadGame())
+    {
+        GridW = Game.GetWidth();
+        GridH = Game.GetHeight();
+        Bombs = Game.GetNumBombs();
+        Topology = Game.GetTopology().GetKind();
+    }
+    else
+    {
+        Game.NewGame(GridW, GridH, Bombs);
+        BeginReplay();
+    }
 
     ChildSlot
     [
@@ -34,11 +61,7 @@ void SMinesweeperWidget::Construct(const FArguments& InArgs)
 
         + SVerticalBox::Slot().FillHeight(1.f).Padding(8.f, 4.f)
         [
-            SNew(SScrollBox)
-            + SScrollBox::Slot()
-            [
-                BuildBoard()
-            ]
+            BuildBoard()
         ]
     ];
 
@@ -46,6 +69,54 @@ void SMinesweeperWidget::Construct(const FArguments& InArgs)
     UpdateBombWarning();
 }
 
+SMinesweeperWidget::~SMinesweeperWidget()
+{
+    if (Pending.IsValid())
+    {
+        Pending->Control.bCancel = true;
+    }
+    if (PendingProbabilities.IsValid())
+    {
+        PendingProbabilities->bCancel = true;
+    }
+    SaveGame();
+    SaveReplay();
+}
+
+// Restores the saved game if there is one that is still being played
+bool SMinesweeperWidget::LoadGame()
+{
+    TUniquePtr<FArchive> Reader(IFileManager::Get().CreateFileReader(*GetSavedGamePath()));
+    if (!Reader.IsValid()) return false;
+
+    Game.Serialize(*Reader);
+    const bool bLoaded = Reader->Close() && !Game.IsGameOver();
+    if (!bLoaded) return false;
+
+    // Earlier clicks are not in the replay, so the restored game cannot be replayed
+    Replay.Moves.Reset();
+    bRecordingReplay = false;
+    return true;
+}
+
+// Keeps an unfinished game for the next time the tab opens; finished games are discarded
+void SMinesweeperWidget::SaveGame()
+{
+    // Game is left behind while an endless game is played, so it is not worth keeping either
+    if (Game.IsGameOver() || bEndlessGame)
+    {
+        IFileManager::Get().Delete(*GetSavedGamePath(), false, false, true);
+        return;
+    }
+
+    TUniquePtr<FArchive> Writer(IFileManager::Get().CreateFileWriter(*GetSavedGamePath()));
+    if (Writer.IsValid())
+    {
+        Game.Serialize(*Writer);
+        Writer->Close();
+    }
+}
+
 //Top Bar controls for inputting height, width, bombs
 TSharedRef<SWidget> SMinesweeperWidget::BuildHeaderBar()
 {
@@ -60,7 +131,7 @@ TSharedRef<SWidget> SMinesweeperWidget::BuildHeaderBar()
     + SHorizontalBox::Slot().AutoWidth().Padding(0,0,16,0)
     [
         SNew(SSpinBox<int32>)
-        .MinValue(1).MaxValue(200)
+        .MinValue(1).MaxValue(kMaxGridSide)
         .Value_Lambda([this]{ return GridW; })
         .OnValueChanged_Lambda([this](int32 V)
         {
@@ -78,7 +149,7 @@ TSharedRef<SWidget> SMinesweeperWidget::BuildHeaderBar()
     + SHorizontalBox::Slot().AutoWidth().Padding(0,0,16,0)
     [
         SNew(SSpinBox<int32>)
-        .MinValue(1).MaxValue(200)
+        .MinValue(1).MaxValue(kMaxGridSide)
         .Value_Lambda([this]{ return GridH; })
         .OnValueChanged_Lambda([this](int32 V)
         {
@@ -96,7 +167,7 @@ TSharedRef<SWidget> SMinesweeperWidget::BuildHeaderBar()
     + SHorizontalBox::Slot().AutoWidth().Padding(0,0,16,0)
     [
         SNew(SSpinBox<int32>)
-        .MinValue(0).MaxValue(40000)
+        .MinValue(0).MaxValue(kMaxGridSide * kMaxGridSide / 2)
         .Value_Lambda([this]{ return Bombs; })
         .OnValueChanged_Lambda([this](int32 V)
         {
@@ -106,6 +177,68 @@ TSharedRef<SWidget> SMinesweeperWidget::BuildHeaderBar()
         .Delta(1)
     ]
 
+    // No-guess generation
+    + SHorizontalBox::Slot().AutoWidth().Padding(0,0,16,0).VAlign(VAlign_Center)
+    [
+        SNew(SCheckBox)
+        .IsChecked_Lambda([this]{ return bNoGuess ? ECheckBoxState::Checked : ECheckBoxState::Unchecked; })
+        .OnCheckStateChanged_Lambda([this](ECheckBoxState State){ bNoGuess = (State == ECheckBoxState::Checked); })
+        [
+            SNew(STextBlock).Text(LOCTEXT("NoGuessLbl", "No guess"))
+        ]
+    ]
+
+    // Endless board at the density of the size and bombs above
+    + SHorizontalBox::Slot().AutoWidth().Padding(0,0,16,0).VAlign(VAlign_Center)
+    [
+        SNew(SCheckBox)
+        .IsChecked_Lambda([this]{ return bEndlessMode ? ECheckBoxState::Checked : ECheckBoxState::Unchecked; })
+        .OnCheckStateChanged_Lambda([this](ECheckBoxState State){ bEndlessMode = (State == ECheckBoxState::Checked); })
+        .ToolTipText(LOCTEXT("EndlessTip", "Unbounded board, generated as you explore, with as many bombs per tile as the size and bombs set here"))
+        [
+            SNew(STextBlock).Text(LOCTEXT("EndlessLbl", "Endless"))
+        ]
+    ]
+
+    // Mine probability overlay, worked out in the background after every move
+    + SHorizontalBox::Slot().AutoWidth().Padding(0,0,16,0).VAlign(VAlign_Center)
+    [
+        SNew(SCheckBox)
+        .IsChecked_Lambda([this]{ return bShowProbabilities ? ECheckBoxState::Checked : ECheckBoxState::Unchecked; })
+        .OnCheckStateChanged_Lambda([this](ECheckBoxState State)
+        {
+            bShowProbabilities = (State == ECheckBoxState::Checked);
+            RequestProbabilities();
+        })
+        [
+            SNew(STextBlock).Text(LOCTEXT("OddsLbl", "Mine odds"))
+        ]
+    ]
+
+    // Topology; cycles through the built-in kinds (graph boards come from code only)
+    + SHorizontalBox::Slot().AutoWidth().Padding(0,0,16,0).VAlign(VAlign_Center)
+    [
+        SNew(SButton)
+        .Text_Lambda([this]
+        {
+            switch (Topology)
+            {
+            case EMinesweeperTopology::Hex:   return LOCTEXT("TopologyHex", "Hex");
+            case EMinesweeperTopology::Torus: return LOCTEXT("TopologyTorus", "Torus");
+            case EMinesweeperTopology::Graph: return LOCTEXT("TopologyGraph", "Graph");
+            default:                          return LOCTEXT("TopologySquare", "Square");
+            }
+        })
+        .ToolTipText(LOCTEXT("TopologyTip", "Board topology for the next game"))
+        .OnClicked_Lambda([this]
+        {
+            Topology = Topology == EMinesweeperTopology::Square ? EMinesweeperTopology::Hex
+                : Topology == EMinesweeperTopology::Hex ? EMinesweeperTopology::Torus
+                : EMinesweeperTopology::Square;
+            return FReply::Handled();
+        })
+    ]
+
     // Start + warning
     + SHorizontalBox::Slot().AutoWidth().VAlign(VAlign_Center)
     [
@@ -118,6 +251,22 @@ TSharedRef<SWidget> SMinesweeperWidget::BuildHeaderBar()
             .OnClicked(this, &SMinesweeperWidget::OnNewGameClicked)
         ]
 
+        + SHorizontalBox::Slot().AutoWidth().Padding(8,0,0,0)
+        [
+            SNew(SButton)
+            .Text(LOCTEXT("Undo", "Undo"))
+            .IsEnabled_Lambda([this]{ return !bEndlessGame && Game.CanUndo() && !IsGenerating(); })
+            .OnClicked(this, &SMinesweeperWidget::OnUndoClicked)
+        ]
+
+        + SHorizontalBox::Slot().AutoWidth().Padding(4,0,0,0)
+        [
+            SNew(SButton)
+            .Text(LOCTEXT("Redo", "Redo"))
+            .IsEnabled_Lambda([this]{ return !bEndlessGame && Game.CanRedo() && !IsGenerating(); })
+            .OnClicked(this, &SMinesweeperWidget::OnRedoClicked)
+        ]
+
         + SHorizontalBox::Slot().AutoWidth().Padding(8,0,0,0).VAlign(VAlign_Center)
         [
             SAssignNew(BombWarningText, STextBlock)
@@ -125,198 +274,573 @@ TSharedRef<SWidget> SMinesweeperWidget::BuildHeaderBar()
             .ColorAndOpacity(FSlateColor(FLinearColor::Yellow))
             .Visibility(EVisibility::Collapsed)
         ]
+
+        + SHorizontalBox::Slot().AutoWidth().Padding(8,0,0,0).VAlign(VAlign_Center)
+        [
+            SAssignNew(GenerationText, STextBlock)
+            .Text(FText::GetEmpty())
+        ]
+
+        // Bombs left / result; read straight from the game's counters
+        + SHorizontalBox::Slot().AutoWidth().Padding(16,0,0,0).VAlign(VAlign_Center)
+        [
+            SNew(STextBlock)
+            .Text_Lambda([this]
+            {
+                if (bEndlessGame)
+                {
+                    return FText::Format(LOCTEXT("StatusEndless", "{0}Cleared: {1}  Flags: {2}"),
+                        Endless.IsGameOver() ? LOCTEXT("StatusEndlessLost", "Boom! ") : FText::GetEmpty(),
+                        FText::AsNumber(Endless.GetTilesRevealed()), FText::AsNumber(Endless.GetFlagsPlaced()));
+                }
+                if (Game.IsWon()) return LOCTEXT("StatusWon", "Cleared!");
+                if (Game.IsGameOver()) return LOCTEXT("StatusLost", "Boom");
+                return FText::Format(LOCTEXT("StatusBombsLeft", "Bombs left: {0}"), FText::AsNumber(Game.GetBombsLeft()));
+            })
+        ]
     ];
 }
 
 //Creating Minesweeper Grid
 TSharedRef<SWidget> SMinesweeperWidget::BuildBoard()
 {
-    SAssignNew(GridPanel, SGridPanel);
-
-    const int32 W = Game.GetWidth();
-    const int32 H = Game.GetHeight();
+    MINESWEEPER_SCOPE(Minesweeper_BuildBoard, STAT_MinesweeperBuildBoard);
+    SET_DWORD_STAT(STAT_MinesweeperWidgetsCreated, 1);
+    // One leaf widget paints every tile, instead of a button/scale box/box/text per tile
+    return SAssignNew(Board, SMinesweeperBoard)
+        .Game(&Game)
+        .Endless(&Endless)
+        .TileSize(kTilePx)
+        .TilePadding(kSlotPad)
+        .OnTileClicked(this, &SMinesweeperWidget::OnTileClicked)
+        .OnTileFlagged(this, &SMinesweeperWidget::OnTileFlagged)
+        .OnViewChanged(this, &SMinesweeperWidget::OnBoardViewChanged);
+}
 
-    static FButtonStyle Flat = []{
-        FButtonStyle S = FAppStyle::Get().GetWidgetStyle<FButtonStyle>("Button");
-        S.NormalPadding  = FMargin(0);
-        S.PressedPadding = FMargin(0);
-        return S;
-    }();
+//Runs Start New Game
+FReply SMinesweeperWidget::OnNewGameClicked()
+{
+    const int32 TotalTiles = GridW * GridH;
 
-    for (int32 y = 0; y < H; ++y)
+    // Hard rule: block if bombs >= 50% of tiles
+    if (TotalTiles > 0 && Bombs >= TotalTiles * 0.5f)
     {
-        for (int32 x = 0; x < W; ++x)
-        {
-            const FMSPTile& T = Game.Get(x, y);
-            const FText Label = T.bRevealed
-                ? (T.bIsBomb ? LOCTEXT("Bomb", "💣") : FText::AsNumber(T.Adjacent))
-                : FText();
-
-            GridPanel->AddSlot(x, y)
-            .Padding(kSlotPad)
-            .HAlign(HAlign_Fill)
-            .VAlign(VAlign_Fill)
-            [
-                SNew(SButton)
-                .ButtonStyle(&Flat)
-                .ContentPadding(FMargin(0))
-                .OnClicked_Lambda([this, x, y]() { return OnTileClicked(x, y); })
-                [
-                    SNew(SScaleBox)
-                    .Stretch(EStretch::ScaleToFit)
-                    .HAlign(HAlign_Center)
-                    .VAlign(VAlign_Center)
-                    [
-                        SNew(SBox)
-                        .MinDesiredWidth(kTilePx)
-                        .MinDesiredHeight(kTilePx)
-                        [
-                            SNew(STextBlock)
-                            .Justification(ETextJustify::Center)
-                            .Text(Label)
-                        ]
-                    ]
-                ]
-            ];
-        }
+        FMessageDialog::Open(EAppMsgType::Ok, LOCTEXT("TooManyBombs", "Bombs cannot be 50% or more of the grid!"));
+        return FReply::Handled();
     }
 
-    return GridPanel.ToSharedRef();
+    // Clamp bombs to feasible amount (ensure at least one safe tile)
+    const int32 MaxBombs = FMath::Clamp(Bombs, 0, FMath::Max(0, TotalTiles - 1));
+    Bombs = MaxBombs;
+
+    // The game being replaced is finished as far as its replay is concerned
+    SaveReplay();
+    bRecordingReplay = false;
+
+    if (bEndlessMode)
+    {
+        StartEndless();
+    }
+    else
+    {
+        StartGeneration();
+    }
+    return FReply::Handled();
 }
 
-//Runs Start New Game
-FReply SMinesweeperWidget::OnNewGameClicked()
+// Endless games need no generation: chunks are made as the player reaches them
+void SMinesweeperWidget::StartEndless()
 {
-    const int32 TotalTiles = GridW * GridH;
+    if (Pending.IsValid())
+    {
+        Pending->Control.bCancel = true;
+        Pending.Reset();
+    }
+    const double Density = double(Bombs) / FMath::Max(1, GridW * GridH);
+    Endless.NewGame(FMath::RoundToInt(Density * FMinesweeperChunkedBoard::ChunkSize * FMinesweeperChunkedBoard::ChunkSize));
+    bEndlessGame = true;
+    QueuedInput.Reset();
+    Replay.Moves.Reset();
+    RequestProbabilities();
+
+    GenerationText->SetText(FText::GetEmpty());
+    if (Board.IsValid())
+    {
+        Board->SetEndless(true);
+    }
+    RebuildGrid();
+    UpdateBombWarning();
+}
 
-    //Screen-width-based column limit (DPI-aware)
-    FDisplayMetrics DM;
-    FSlateApplication::Get().GetInitialDisplayMetrics(DM);
+void SMinesweeperWidget::OnBoardViewChanged(const FIntRect& VisibleTiles)
+{
+    EndlessView = VisibleTiles;
+    if (bEndlessGame && Endless.PageTo(EndlessView) && Board.IsValid())
+    {
+        Board->RefreshView();
+    }
+}
 
-    const int32 ScreenWidthPx = DM.PrimaryDisplayWorkAreaRect.Right - DM.PrimaryDisplayWorkAreaRect.Left;
+// Builds the next board, bombs included, on a background task; a generation still running is cancelled and its board dropped
+void SMinesweeperWidget::StartGeneration()
+{
+    if (Pending.IsValid())
+    {
+        // The old task holds its own reference, so it can wind down whenever it sees the flag
+        Pending->Control.bCancel = true;
+    }
 
-    // Convert screen pixels to Slate units
-    float AppScale = FSlateApplication::Get().GetApplicationScale();
-    if (AppScale <= 0.f) AppScale = 1.f;
+    TSharedRef<FPendingGeneration, ESPMode::ThreadSafe> Generation = MakeShared<FPendingGeneration, ESPMode::ThreadSafe>();
+    Generation->bNoGuess = bNoGuess;
+    Generation->StartX = GridW / 2;
+    Generation->StartY = GridH / 2;
+    if (Topology == EMinesweeperTopology::Graph)
+    {
+        // Only a restored game can be a graph; the next board reuses its table
+        Generation->Game.SetTopology(Game.GetTopology());
+    }
+    else
+    {
+        Generation->Game.SetTopology(Topology);
+    }
+    Pending = Generation;
+    GenerationStartTime = FPlatformTime::Seconds();
 
-    const float ScreenWidthSlate = ScreenWidthPx / AppScale;
+    const int32 W = GridW, H = GridH, B = Bombs;
+    UE::Tasks::Launch(UE_SOURCE_LOCATION, [Generation, W, H, B]
+    {
+        if (Generation->bNoGuess)
+        {
+            Generation->Stats = Generation->Game.NewGameNoGuess(W, H, B, Generation->StartX, Generation->StartY, 5.0, 0, &Generation->Control);
 
-    // Reserve some space for left/right padding + potential scrollbar, etc.
-    const float ReservedLR = 32.f;
+            // The fallback board after a timeout is opened at the centre like a no-guess one, so it is laid out around it
+            if (!Generation->Game.HasPlacedBombs() && !Generation->Control.bCancel)
+            {
+                Generation->Game.PlaceBombsAround(Generation->StartX, Generation->StartY);
+            }
+        }
+        else
+        {
+            // Plain boards wait for the player's first click to place their bombs, which is cheap enough for the game thread
+            Generation->Game.NewGame(W, H, B);
+        }
+        Generation->bDone = true;
+    });
 
-    // Effective width we can draw tiles into (in Slate units)
-    const float UsableWidth = FMath::Max(0.f, ScreenWidthSlate - ReservedLR);
+    GenerationText->SetText(LOCTEXT("Generating", "Generating..."));
+    if (!GenerationTimer.IsValid())
+    {
+        GenerationTimer = RegisterActiveTimer(0.f, FWidgetActiveTimerDelegate::CreateSP(this, &SMinesweeperWidget::PollGeneration));
+    }
+}
 
-    // Each column costs: tile size + left+right slot padding
-    const float PerColumnSlate = kTilePx + (kSlotPad * 2.f);
+// Shows progress each frame while generating, then swaps the finished board in on the game thread
+EActiveTimerReturnType SMinesweeperWidget::PollGeneration(double InCurrentTime, float InDeltaTime)
+{
+    if (Pending.IsValid() && !Pending->bDone)
+    {
+        // Only the no-guess search makes attempts
+        const FText Elapsed = FText::AsNumber(FMath::RoundToInt((FPlatformTime::Seconds() - GenerationStartTime) * 1000.0));
+        GenerationText->SetText(Pending->bNoGuess
+            ? FText::Format(LOCTEXT("GeneratingProgress", "Generating... {0} attempts ({1} ms)"),
+                FText::AsNumber(Pending->Control.Attempts.load(std::memory_order_relaxed)), Elapsed)
+            : FText::Format(LOCTEXT("GeneratingPlainProgress", "Generating... ({0} ms)"), Elapsed));
+        return EActiveTimerReturnType::Continue;
+    }
 
-    const int32 MaxColsByScreen = FMath::Max(1, FMath::FloorToInt(UsableWidth / PerColumnSlate));
+    GenerationTimer.Reset();
+    if (!Pending.IsValid()) return EActiveTimerReturnType::Stop;
 
-    if (GridW > MaxColsByScreen)
+    // The task is done with its board, so the game thread takes it over in one move; clicks meant for the old one are dropped
+    const TSharedPtr<FPendingGeneration, ESPMode::ThreadSafe> Done = MoveTemp(Pending);
+    Game = MoveTemp(Done->Game);
+    QueuedInput.Reset();
+    BeginReplay();
+    if (bEndlessGame && Board.IsValid())
     {
-        const FText Msg = FText::Format(
-            LOCTEXT("TooManyColsForScreen",
-                "Width ({0}) exceeds the screen's horizontal capacity ({1} columns at current resolution).\n"
-                "Reduce Width or increase screen resolution."),
-            FText::AsNumber(GridW),
-            FText::AsNumber(MaxColsByScreen)
-        );
-        FMessageDialog::Open(EAppMsgType::Ok, Msg);
-        return FReply::Handled();
+        Board->SetEndless(false);
     }
+    bEndlessGame = false;
 
-    // Hard rule: block if bombs >= 50% of tiles
-    if (TotalTiles > 0 && Bombs >= TotalTiles * 0.5f)
+    // Whatever the overlay shows belongs to the old board
+    bProbabilityGameChanged = true;
+    ProbabilityChangedTiles.Reset();
+    if (PendingProbabilities.IsValid())
     {
-        FMessageDialog::Open(EAppMsgType::Ok, LOCTEXT("TooManyBombs", "Bombs cannot be 50% or more of the grid!"));
-        return FReply::Handled();
+        PendingProbabilities->bCancel = true;
+    }
+    if (Board.IsValid())
+    {
+        Board->SetProbabilities({});
     }
 
-    // Clamp bombs to feasible amount (ensure at least one safe tile)
-    const int32 MaxBombs = FMath::Clamp(Bombs, 0, FMath::Max(0, TotalTiles - 1));
-    Bombs = MaxBombs;
-
-    Game.NewGame(GridW, GridH, Bombs);
+    if (Done->bNoGuess)
+    {
+        // A no-guess board is solvable from the centre, so it is opened there for the player
+        bool bHitBomb = false;
+        RecordMove(Done->StartX, Done->StartY, EMinesweeperMoveKind::Reveal);
+        Game.Click(Done->StartX, Done->StartY, bHitBomb, ChangedTiles);
+
+        const FMinesweeperNoGuessStats& Stats = Done->Stats;
+        GenerationText->SetText(FText::Format(
+            Stats.bSucceeded
+                ? LOCTEXT("NoGuessFound", "No-guess board after {0} attempts ({1} ms)")
+                : LOCTEXT("NoGuessTimedOut", "No no-guess board in {0} attempts ({1} ms); plain board used"),
+            FText::AsNumber(Stats.Attempts),
+            FText::AsNumber(FMath::RoundToInt(Stats.Seconds * 1000.0))));
+    }
+    else
+    {
+        GenerationText->SetText(FText::GetEmpty());
+    }
     RebuildGrid();
+    RequestProbabilities();
 
     // Re-check soft warning after starting
     UpdateBombWarning();
-
-    return FReply::Handled();
+    return EActiveTimerReturnType::Stop;
 }
 
 // Rebuilds Game whenever new game is started
 void SMinesweeperWidget::RebuildGrid()
 {
-    if (!GridPanel.IsValid()) return;
+    MINESWEEPER_SCOPE(Minesweeper_RebuildGrid, STAT_MinesweeperRebuildGrid);
+    // The board paints every tile itself, so a rebuild never creates widgets
+    SET_DWORD_STAT(STAT_MinesweeperWidgetsCreated, 0);
+    if (!Board.IsValid()) return;
 
-    GridPanel->ClearChildren();
+    Board->RefreshBoard();
+}
 
-    const int32 W = Game.GetWidth();
-    const int32 H = Game.GetHeight();
+// Repaints the board after the given tiles changed; layout is untouched
+void SMinesweeperWidget::UpdateTiles(const TArray<int32>& Changed)
+{
+    if (bShowProbabilities)
+    {
+        ProbabilityChangedTiles.Append(Changed);
+    }
+    if (!Board.IsValid()) return;
+
+    Board->RefreshTiles(Changed);
+}
+
+//Queues a Tile Click; a click on a revealed number chords when the queue is applied
+void SMinesweeperWidget::OnTileClicked(int32 X, int32 Y)
+{
+    QueueInput(X, Y, false);
+}
+
+// Input is applied on the next frame, so a burst of clicks costs one board update
+void SMinesweeperWidget::QueueInput(int32 X, int32 Y, bool bFlag)
+{
+    if (IsPlayOver() || IsGenerating()) return;
 
-    static FButtonStyle Flat = []{
-        FButtonStyle S = FAppStyle::Get().GetWidgetStyle<FButtonStyle>("Button");
-        S.NormalPadding  = FMargin(0);
-        S.PressedPadding = FMargin(0);
-        return S;
-    }();
+    QueuedInput.Add({ FIntPoint(X, Y), bFlag });
+    if (!InputTimer.IsValid())
+    {
+        InputTimer = RegisterActiveTimer(0.f, FWidgetActiveTimerDelegate::CreateSP(this, &SMinesweeperWidget::ApplyQueuedInput));
+    }
+}
+
+// Runs once per frame with input queued: consecutive reveals go in as one ClickMany, chords and flags one by one,
+// and the board, the end-of-game check and the probability overlay are updated once for the lot.
+// Each input is classified against the board its earlier inputs left, as if they had been applied one at a time.
+EActiveTimerReturnType SMinesweeperWidget::ApplyQueuedInput(double InCurrentTime, float InDeltaTime)
+{
+    MINESWEEPER_SCOPE(Minesweeper_ApplyQueuedInput, STAT_MinesweeperApplyQueuedInput);
+    InputTimer.Reset();
+    if (bEndlessGame)
+    {
+        ApplyEndlessInput();
+        return EActiveTimerReturnType::Stop;
+    }
+    FrameChangedTiles.Reset();
 
-    for (int32 y = 0; y < H; ++y)
+    bool bHitBomb = false;
+    int32 i = 0;
+    auto IsChord = [this](const FQueuedInput& Input)
+    {
+        return !Input.bFlag && Game.IsValid(Input.Tile.X, Input.Tile.Y) && Game.Get(Input.Tile.X, Input.Tile.Y).bRevealed;
+    };
+    while (i < QueuedInput.Num() && !Game.IsGameOver() && !IsGenerating())
     {
-        for (int32 x = 0; x < W; ++x)
+        const FQueuedInput& Input = QueuedInput[i];
+        if (Input.bFlag)
         {
-            const FMSPTile& T = Game.Get(x, y);
-            const FText Label = T.bRevealed
-                ? (T.bIsBomb ? LOCTEXT("Bomb", "💣") : FText::AsNumber(T.Adjacent))
-                : FText();
-
-            GridPanel->AddSlot(x, y)
-            .Padding(kSlotPad)
-            .HAlign(HAlign_Fill)
-            .VAlign(VAlign_Fill)
-            [
-                SNew(SButton)
-                .ButtonStyle(&Flat)
-                .ContentPadding(FMargin(0))
-                .OnClicked_Lambda([this, x, y]() { return OnTileClicked(x, y); })
-                [
-                    SNew(SScaleBox)
-                    .Stretch(EStretch::ScaleToFit)
-                    .HAlign(HAlign_Center)
-                    .VAlign(VAlign_Center)
-                    [
-                        SNew(SBox)
-                        .MinDesiredWidth(kTilePx)
-                        .MinDesiredHeight(kTilePx)
-                        [
-                            SNew(STextBlock)
-                            .Justification(ETextJustify::Center)
-                            .Text(Label)
-                        ]
-                    ]
-                ]
-            ];
+            Game.ToggleFlag(Input.Tile.X, Input.Tile.Y, ChangedTiles);
+            if (ChangedTiles.Num() > 0) RecordMove(Input.Tile.X, Input.Tile.Y, EMinesweeperMoveKind::Flag);
+            ++i;
         }
+        else if (IsChord(Input))
+        {
+            Game.Chord(Input.Tile.X, Input.Tile.Y, bHitBomb, ChangedTiles);
+            if (ChangedTiles.Num() > 0) RecordMove(Input.Tile.X, Input.Tile.Y, EMinesweeperMoveKind::Chord);
+            ++i;
+        }
+        else
+        {
+            RevealBatch.Reset();
+            for (int32 j = i; j < QueuedInput.Num() && !QueuedInput[j].bFlag && !IsChord(QueuedInput[j]); ++j)
+            {
+                RevealBatch.Add(QueuedInput[j].Tile);
+            }
+
+            // A point the batch has opened by the time it is reached is a chord, so the batch ends there and the loop
+            // classifies it again. Replaying every recorded point gives the same board: ClickMany skips the ones that
+            // open nothing, as Click does; a tile still flagged afterwards was skipped, so it is not recorded.
+            const int32 NumApplied = Game.ClickMany(RevealBatch, bHitBomb, ChangedTiles, true);
+            for (int32 k = 0; k < NumApplied; ++k)
+            {
+                const FIntPoint Tile = RevealBatch[k];
+                if (Game.IsValid(Tile.X, Tile.Y) && !Game.Get(Tile.X, Tile.Y).bFlagged) RecordMove(Tile.X, Tile.Y, EMinesweeperMoveKind::Reveal);
+            }
+            i += FMath::Max(1, NumApplied);
+        }
+        FrameChangedTiles.Append(ChangedTiles);
     }
+    QueuedInput.Reset();
+
+    UpdateTiles(FrameChangedTiles);
+    if (FrameChangedTiles.Num() > 0)
+    {
+        OnMoveFinished(bHitBomb);
+        RequestProbabilities();
+    }
+    return EActiveTimerReturnType::Stop;
 }
 
-//Processes Tile Click
-FReply SMinesweeperWidget::OnTileClicked(int32 X, int32 Y)
+// Inputs go in one at a time, a click on a revealed number chording as on the dense board
+void SMinesweeperWidget::ApplyEndlessInput()
 {
-    bool bHitBomb = false, bChanged = false;
-    Game.Click(X, Y, bHitBomb, bChanged);
-    if (bChanged)
+    EndlessFrameChanged.Reset();
+    for (const FQueuedInput& Input : QueuedInput)
     {
-        RebuildGrid();
+        if (Endless.IsGameOver() || IsGenerating()) break;
+
+        const FIntPoint Tile = Input.Tile;
+        bool bHitBomb = false;
+        if (Input.bFlag)
+        {
+            Endless.ToggleFlag(Tile.X, Tile.Y, EndlessChanged);
+        }
+        else if (Endless.Get(Tile.X, Tile.Y).bRevealed)
+        {
+            Endless.Chord(Tile.X, Tile.Y, bHitBomb, EndlessChanged);
+        }
+        else
+        {
+            Endless.Click(Tile.X, Tile.Y, bHitBomb, EndlessChanged);
+        }
+        EndlessFrameChanged.Append(EndlessChanged);
     }
-    if (bHitBomb)
+    QueuedInput.Reset();
+
+    if (!Board.IsValid()) return;
+    if (Endless.IsGameOver())
     {
+        // Every chunk in view is paged in to show its bombs
+        Endless.PageTo(EndlessView);
+        Board->RefreshView();
         FMessageDialog::Open(EAppMsgType::Ok, LOCTEXT("GameOver", "Game Over!"));
     }
+    else
+    {
+        Board->RefreshTiles(EndlessFrameChanged);
+    }
+}
+
+// Steps the game back one move, even out of a loss; only the tiles that move touched are refreshed
+FReply SMinesweeperWidget::OnUndoClicked()
+{
+    if (Game.Undo(ChangedTiles))
+    {
+        // From here on it is practice: the replay keeps only the moves that were really played
+        SaveReplay();
+        bRecordingReplay = false;
+        UpdateTiles(ChangedTiles);
+        RequestProbabilities();
+    }
+    return FReply::Handled();
+}
+
+FReply SMinesweeperWidget::OnRedoClicked()
+{
+    if (Game.Redo(ChangedTiles))
+    {
+        UpdateTiles(ChangedTiles);
+        RequestProbabilities();
+    }
     return FReply::Handled();
 }
 
+// Right click toggles a flag
+void SMinesweeperWidget::OnTileFlagged(int32 X, int32 Y)
+{
+    QueueInput(X, Y, true);
+}
+
+// Ends the replay and tells the player once the game is decided
+void SMinesweeperWidget::OnMoveFinished(bool bHitBomb)
+{
+    if (!Game.IsGameOver()) return;
+
+    SaveReplay();
+    FMessageDialog::Open(EAppMsgType::Ok, bHitBomb ? LOCTEXT("GameOver", "Game Over!") : LOCTEXT("GameWon", "You cleared the board!"));
+}
+
+// Only one pass runs at a time; a request made meanwhile is served, with every change made since, once it ends.
+// Flags are ignored by the calculator, so flagging never needs a new pass.
+void SMinesweeperWidget::RequestProbabilities()
+{
+    if (!bShowProbabilities || Game.IsGameOver() || bEndlessGame)
+    {
+        if (PendingProbabilities.IsValid())
+        {
+            PendingProbabilities->bCancel = true;
+        }
+        bProbabilitiesDirty = false;
+        ProbabilityChangedTiles.Reset();
+        bProbabilityResync = true;
+        if (Board.IsValid())
+        {
+            Board->SetProbabilities({});
+        }
+        return;
+    }
+
+    if (PendingProbabilities.IsValid())
+    {
+        bProbabilitiesDirty = true;
+        return;
+    }
+    LaunchProbabilities();
+}
+
+// Snapshots what changed on the game thread and hands it to a task; the calculator keeps the board and its cache between passes
+void SMinesweeperWidget::LaunchProbabilities()
+{
+    TSharedRef<FPendingProbabilities, ESPMode::ThreadSafe> Pass = MakeShared<FPendingProbabilities, ESPMode::ThreadSafe>();
+    if (!Probability.IsValid())
+    {
+        Probability = MakeShared<FMinesweeperProbability, ESPMode::ThreadSafe>();
+        bProbabilityGameChanged = true;
+    }
+    if (bProbabilityGameChanged || bProbabilityResync)
+    {
+        FMinesweeperProbability::Snapshot(Game, Pass->Visible);
+        if (bProbabilityGameChanged)
+        {
+            // The topology's neighbour table is shared, not copied
+            Pass->NewTopology = Game.GetTopology();
+            Pass->Bombs = Game.GetNumBombs();
+        }
+        bProbabilityGameChanged = false;
+        bProbabilityResync = false;
+    }
+    else
+    {
+        // A move costs the game thread the tiles it changed, not the whole board
+        Pass->ChangedTiles = MoveTemp(ProbabilityChangedTiles);
+        FMinesweeperProbability::Snapshot(Game, Pass->ChangedTiles, Pass->ChangedValues);
+    }
+    ProbabilityChangedTiles.Reset();
+    PendingProbabilities = Pass;
+    bProbabilitiesDirty = false;
+
+    const TSharedPtr<FMinesweeperProbability, ESPMode::ThreadSafe> Calculator = Probability;
+    UE::Tasks::Launch(UE_SOURCE_LOCATION, [Pass, Calculator]
+    {
+        if (Pass->NewTopology.IsSet())
+        {
+            Calculator->Reset(Pass->NewTopology.GetValue(), Pass->Bombs);
+        }
+        if (Pass->Visible.Num() > 0)
+        {
+            Calculator->SetVisible(MoveTemp(Pass->Visible));
+        }
+        else
+        {
+            Calculator->UpdateVisible(Pass->ChangedTiles, Pass->ChangedValues);
+        }
+        Pass->bComplete = Calculator->Compute(Pass->Result, Pass->bCancel);
+        Pass->bDone = true;
+    });
+
+    if (!ProbabilityTimer.IsValid())
+    {
+        ProbabilityTimer = RegisterActiveTimer(0.f, FWidgetActiveTimerDelegate::CreateSP(this, &SMinesweeperWidget::PollProbabilities));
+    }
+}
+
+// Hands a finished pass to the board, then starts the one that was asked for while it ran
+EActiveTimerReturnType SMinesweeperWidget::PollProbabilities(double InCurrentTime, float InDeltaTime)
+{
+    if (PendingProbabilities.IsValid() && !PendingProbabilities->bDone)
+    {
+        return EActiveTimerReturnType::Continue;
+    }
+
+    ProbabilityTimer.Reset();
+    const TSharedPtr<FPendingProbabilities, ESPMode::ThreadSafe> Done = MoveTemp(PendingProbabilities);
+    if (Done.IsValid() && Done->bComplete && !Done->bCancel && Board.IsValid())
+    {
+        // Even when a newer pass is due this is closer to the board than what is shown
+        Board->SetProbabilities(MoveTemp(Done->Result));
+    }
+    if (bProbabilitiesDirty)
+    {
+        RequestProbabilities();
+    }
+    return EActiveTimerReturnType::Stop;
+}
+
+// Starts recording the game that was just generated
+void SMinesweeperWidget::BeginReplay()
+{
+    Replay.Width = Game.GetWidth();
+    Replay.Height = Game.GetHeight();
+    Replay.Bombs = Game.GetNumBombs();
+    Replay.Seed = Game.GetSeed();
+    Replay.Topology = Game.GetTopology().GetKind();
+    Replay.Generator = Game.GetGenerator();
+    Replay.Moves.Reset();
+    ReplayStartTime = FPlatformTime::Seconds();
+    // A replay rebuilds the board from its parameters, which a custom graph is not part of
+    bRecordingReplay = !Game.GetTopology().HasFixedSize();
+}
+
+void SMinesweeperWidget::RecordMove(int32 X, int32 Y, EMinesweeperMoveKind Kind)
+{
+    if (!bRecordingReplay) return;
+
+    FMinesweeperReplayMove& Move = Replay.Moves.AddDefaulted_GetRef();
+    Move.X = X;
+    Move.Y = Y;
+    Move.Kind = Kind;
+    Move.TimeMs = uint32((FPlatformTime::Seconds() - ReplayStartTime) * 1000.0);
+}
+
+// Appends the current game to the replay file once, if anything was played
+void SMinesweeperWidget::SaveReplay()
+{
+    if (Replay.Moves.Num() == 0) return;
+
+    const FString Path = FPaths::Combine(FPaths::ProjectSavedDir(), TEXT("Minesweeper"), TEXT("Replays.msreplay"));
+    FMinesweeperReplayWriter Writer;
+    bool bOpened = Writer.Open(Path);
+    if (!bOpened && IFileManager::Get().FileExists(*Path))
+    {
+        // A file this build cannot append to, such as one of an older format, is kept aside for a fresh one
+        IFileManager::Get().Move(*FPaths::Combine(FPaths::GetPath(Path), TEXT("Replays.old.msreplay")), *Path);
+        bOpened = Writer.Open(Path);
+    }
+    if (bOpened)
+    {
+        Writer.Append(Replay);
+    }
+    Replay.Moves.Reset();
+}
+
 // Centralized: show/hide yellow warning for >20% bombs
 void SMinesweeperWidget::UpdateBombWarning()
 {
@@ -0,0 +1,383 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "CoreMinimal.h"
+#include "Misc/AutomationTest.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Misc/App.h"
+#include "HAL/MemoryBase.h"
+#include "Async/TaskGraphInterfaces.h"
+#include "ProfilingDebugging/CpuProfilerTrace.h"
+#include "Dom/JsonObject.h"
+#include "Serialization/JsonWriter.h"
+#include "Serialization/JsonSerializer.h"
+#include "Framework/Application/SlateApplication.h"
+#include "Widgets/SWindow.h"
+#include "Input/HittestGrid.h"
+#include "Rendering/DrawElements.h"
+#include "MinesweeperGameLogic.h"
+#include "Slate/SMinesweeperBoard.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+// Run headless with e.g.
+//   UnrealEditor-Cmd <Project> -nullrhi -unattended -ExecCmds="Automation RunTests Minesweeper.Performance; Quit"
+// Each test writes Saved/Automation/Minesweeper/<Test>.json with median and p99 times per case, plus the median and
+// maximum allocator calls per iteration in builds with stats. Those counts are process-wide, so a stray allocation on
+// another thread can land in one sample; for attributing them, add -trace=cpu,memory and every timed iteration shows
+// up in Unreal Insights as a CPU scope named after its case.
+
+namespace MinesweeperBench
+{
+    struct FCase
+    {
+        FString Name;
+        int32 Width = 0;
+        int32 Height = 0;
+        int32 Bombs = 0;
+        TArray<double> Millis;
+        // Malloc and realloc calls per iteration; empty when the allocator keeps no counts
+        TArray<int64> Allocs;
+    };
+
+    // Process-wide malloc and realloc calls so far, which the allocator counts in builds with stats; -1 without them
+    int64 AllocationCalls()
+    {
+        FGenericMemoryStats Stats;
+        GMalloc->GetAllocatorStats(Stats);
+        const SIZE_T* Mallocs = Stats.Data.Find(TEXT("Malloc calls"));
+        const SIZE_T* Reallocs = Stats.Data.Find(TEXT("Realloc calls"));
+        return Mallocs && Reallocs ? int64(*Mallocs + *Reallocs) : -1;
+    }
+
+    // Calls a snapshot makes itself after reading the counts, i.e. what an empty body would show
+    int64 SnapshotAllocationCalls()
+    {
+        static const int64 Calls = []
+        {
+            const int64 First = AllocationCalls();
+            return FMath::Max<int64>(0, AllocationCalls() - First);
+        }();
+        return Calls;
+    }
+
+    // Times Body Iterations times after a fresh Setup each and counts its allocations; Setup is neither timed nor traced.
+    // Game thread tasks are drained first so they do not allocate inside the snapshots.
+    template <typename SetupType, typename BodyType>
+    void Measure(FCase& Case, int32 Iterations, SetupType&& Setup, BodyType&& Body)
+    {
+        const int64 SnapshotCalls = SnapshotAllocationCalls();
+        for (int32 i = 0; i < Iterations; ++i)
+        {
+            Setup(i);
+            FTaskGraphInterface::Get().ProcessThreadUntilIdle(ENamedThreads::GameThread);
+
+            const int64 AllocsBefore = AllocationCalls();
+            const double Start = FPlatformTime::Seconds();
+            {
+                TRACE_CPUPROFILER_EVENT_SCOPE_TEXT(*Case.Name);
+                Body(i);
+            }
+            const double End = FPlatformTime::Seconds();
+            const int64 AllocsAfter = AllocationCalls();
+
+            Case.Millis.Add((End - Start) * 1000.0);
+            if (AllocsBefore >= 0)
+            {
+                Case.Allocs.Add(FMath::Max<int64>(0, AllocsAfter - AllocsBefore - SnapshotCalls));
+            }
+        }
+    }
+
+    template <typename T>
+    T Percentile(TArray<T> Values, double P)
+    {
+        if (Values.Num() == 0) return T(0);
+        Values.Sort();
+        const int32 Index = FMath::Clamp(FMath::CeilToInt(P * Values.Num()) - 1, 0, Values.Num() - 1);
+        return Values[Index];
+    }
+
+    // Logs every case and writes them as one JSON document per test
+    void Report(FAutomationTestBase& Test, const FString& TestName, const TArray<FCase>& Cases)
+    {
+        TArray<TSharedPtr<FJsonValue>> Results;
+        for (const FCase& Case : Cases)
+        {
+            const double Median = Percentile(Case.Millis, 0.5);
+            const double P99 = Percentile(Case.Millis, 0.99);
+
+            TSharedRef<FJsonObject> Obj = MakeShared<FJsonObject>();
+            Obj->SetStringField(TEXT("case"), Case.Name);
+            Obj->SetNumberField(TEXT("width"), Case.Width);
+            Obj->SetNumberField(TEXT("height"), Case.Height);
+            Obj->SetNumberField(TEXT("bombs"), Case.Bombs);
+            Obj->SetNumberField(TEXT("samples"), Case.Millis.Num());
+            Obj->SetNumberField(TEXT("median_ms"), Median);
+            Obj->SetNumberField(TEXT("p99_ms"), P99);
+
+            FString AllocsText;
+            if (Case.Allocs.Num() > 0)
+            {
+                const int64 MedianAllocs = Percentile(Case.Allocs, 0.5);
+                const int64 MaxAllocs = Percentile(Case.Allocs, 1.0);
+                Obj->SetNumberField(TEXT("median_allocs"), double(MedianAllocs));
+                Obj->SetNumberField(TEXT("max_allocs"), double(MaxAllocs));
+                AllocsText = FString::Printf(TEXT(", allocs median %lld max %lld"), MedianAllocs, MaxAllocs);
+            }
+            Results.Add(MakeShared<FJsonValueObject>(Obj));
+
+            Test.AddInfo(FString::Printf(TEXT("%s %dx%d bombs=%d: median %.3f ms, p99 %.3f ms%s"),
+                *Case.Name, Case.Width, Case.Height, Case.Bombs, Median, P99, *AllocsText));
+        }
+
+        TSharedRef<FJsonObject> Root = MakeShared<FJsonObject>();
+        Root->SetStringField(TEXT("test"), TestName);
+        Root->SetStringField(TEXT("build"), FApp::GetBuildVersion());
+        Root->SetArrayField(TEXT("results"), Results);
+
+        FString Json;
+        const TSharedRef<TJsonWriter<>> Writer = TJsonWriterFactory<>::Create(&Json);
+        FJsonSerializer::Serialize(Root, Writer);
+
+        const FString Path = FPaths::Combine(FPaths::ProjectSavedDir(), TEXT("Automation"), TEXT("Minesweeper"), TestName + TEXT(".json"));
+        if (!FFileHelper::SaveStringToFile(Json, *Path))
+        {
+            Test.AddWarning(FString::Printf(TEXT("Could not write benchmark report to %s"), *Path));
+        }
+    }
+
+    // Board sizes from the presets up to multi-million tiles
+    static const FIntPoint Sizes[] = { {9, 9}, {30, 16}, {200, 200}, {1000, 1000}, {2000, 2000} };
+
+    // Bomb densities: none (everything cascades), beginner-like, expert-like
+    static const float Densities[] = { 0.f, 0.12f, 0.2f };
+
+    int32 IterationsFor(FIntPoint Size)
+    {
+        return Size.X * Size.Y >= 1000000 ? 9 : 101;
+    }
+
+    constexpr int32 FixedSeed = 12345;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FMinesweeperNewGameBenchmark, "Minesweeper.Performance.NewGame",
+    EAutomationTestFlags::EditorContext | EAutomationTestFlags::PerfFilter)
+
+bool FMinesweeperNewGameBenchmark::RunTest(const FString& Parameters)
+{
+    using namespace MinesweeperBench;
+
+    TArray<FCase> Cases;
+    for (const FIntPoint Size : Sizes)
+    {
+        for (const float Density : Densities)
+        {
+            for (const EMinesweeperGenerator Generator : { EMinesweeperGenerator::Stream, EMinesweeperGenerator::Counter })
+            {
+                FCase& Case = Cases.AddDefaulted_GetRef();
+                Case.Name = Generator == EMinesweeperGenerator::Counter ? TEXT("NewGame (counter)") : TEXT("NewGame");
+                Case.Width = Size.X;
+                Case.Height = Size.Y;
+                Case.Bombs = FMath::FloorToInt(Size.X * Size.Y * Density);
+
+                // Bombs are placed on the first click, so generation is NewGame plus that placement
+                FMinesweeperGameLogic Game;
+                Game.SetGenerator(Generator);
+                Measure(Case, IterationsFor(Size),
+                    [](int32) {},
+                    [&](int32 i)
+                    {
+                        Game.NewGame(Case.Width, Case.Height, Case.Bombs, FixedSeed + i);
+                        Game.PlaceBombsAround(Case.Width / 2, Case.Height / 2);
+                    });
+            }
+        }
+    }
+
+    Report(*this, TEXT("NewGame"), Cases);
+    return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FMinesweeperClickBenchmark, "Minesweeper.Performance.Click",
+    EAutomationTestFlags::EditorContext | EAutomationTestFlags::PerfFilter)
+
+bool FMinesweeperClickBenchmark::RunTest(const FString& Parameters)
+{
+    using namespace MinesweeperBench;
+
+    // Random clicks on a fresh board each; covers single reveals, small cascades and bomb hits
+    TArray<FCase> Cases;
+    for (const FIntPoint Size : Sizes)
+    {
+        for (const float Density : Densities)
+        {
+            if (Density == 0.f) continue; // covered by the cascade benchmark
+
+            FCase& Case = Cases.AddDefaulted_GetRef();
+            Case.Name = TEXT("Click");
+            Case.Width = Size.X;
+            Case.Height = Size.Y;
+            Case.Bombs = FMath::FloorToInt(Size.X * Size.Y * Density);
+
+            FMinesweeperGameLogic Game;
+            FRandomStream Rng(FixedSeed);
+            TArray<int32> Changed;
+            bool bHitBomb = false;
+            FIntPoint Target;
+            Measure(Case, IterationsFor(Size) * 4,
+                [&](int32 i)
+                {
+                    if (i % 4 == 0)
+                    {
+                        Game.NewGame(Case.Width, Case.Height, Case.Bombs, FixedSeed + i);
+                        Game.PlaceBombsAround(Rng.RandRange(0, Case.Width - 1), Rng.RandRange(0, Case.Height - 1));
+                    }
+                    Target = FIntPoint(Rng.RandRange(0, Case.Width - 1), Rng.RandRange(0, Case.Height - 1));
+                },
+                [&](int32) { Game.Click(Target.X, Target.Y, bHitBomb, Changed); });
+
+            // A frame's worth of queued clicks on a fresh board, one by one and as one batch
+            for (const bool bBatch : { false, true })
+            {
+                FCase& BurstCase = Cases.AddDefaulted_GetRef();
+                BurstCase.Name = bBatch ? TEXT("ClickMany x64") : TEXT("Click x64");
+                BurstCase.Width = Size.X;
+                BurstCase.Height = Size.Y;
+                BurstCase.Bombs = FMath::FloorToInt(Size.X * Size.Y * Density);
+
+                FRandomStream BurstRng(FixedSeed);
+                TArray<FIntPoint> Targets;
+                Measure(BurstCase, IterationsFor(Size),
+                    [&](int32 i)
+                    {
+                        Game.NewGame(BurstCase.Width, BurstCase.Height, BurstCase.Bombs, FixedSeed + i);
+                        Game.PlaceBombsAround(BurstRng.RandRange(0, BurstCase.Width - 1), BurstRng.RandRange(0, BurstCase.Height - 1));
+                        Targets.Reset();
+                        for (int32 t = 0; t < 64; ++t)
+                        {
+                            Targets.Add(FIntPoint(BurstRng.RandRange(0, BurstCase.Width - 1), BurstRng.RandRange(0, BurstCase.Height - 1)));
+                        }
+                    },
+                    [&](int32)
+                    {
+                        if (bBatch)
+                        {
+                            Game.ClickMany(Targets, bHitBomb, Changed);
+                            return;
+                        }
+                        for (const FIntPoint& Point : Targets)
+                        {
+                            Game.Click(Point.X, Point.Y, bHitBomb, Changed);
+                            if (bHitBomb) break;
+                        }
+                    });
+            }
+        }
+    }
+
+    Report(*this, TEXT("Click"), Cases);
+    return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FMinesweeperCascadeBenchmark, "Minesweeper.Performance.FloodFillCascade",
+    EAutomationTestFlags::EditorContext | EAutomationTestFlags::PerfFilter)
+
+bool FMinesweeperCascadeBenchmark::RunTest(const FString& Parameters)
+{
+    using namespace MinesweeperBench;
+
+    // Worst case for FloodFillZeros: an empty or near-empty board where one click opens everything
+    TArray<FCase> Cases;
+    for (const FIntPoint Size : Sizes)
+    {
+        for (const int32 Bombs : { 0, 1 })
+        {
+            FCase& Case = Cases.AddDefaulted_GetRef();
+            Case.Name = TEXT("FloodFillCascade");
+            Case.Width = Size.X;
+            Case.Height = Size.Y;
+            Case.Bombs = Bombs;
+
+            FMinesweeperGameLogic Game;
+            TArray<int32> Changed;
+            Changed.Reserve(Size.X * Size.Y);
+            bool bHitBomb = false;
+            FIntPoint Target;
+            Measure(Case, IterationsFor(Size),
+                [&](int32 i)
+                {
+                    // Placing around the target keeps its neighbours clear, so the click always cascades
+                    Target = FIntPoint(Case.Width / 2, Case.Height / 2);
+                    Game.NewGame(Case.Width, Case.Height, Case.Bombs, FixedSeed + i);
+                    Game.PlaceBombsAround(Target.X, Target.Y);
+                },
+                [&](int32) { Game.Click(Target.X, Target.Y, bHitBomb, Changed); });
+        }
+    }
+
+    Report(*this, TEXT("FloodFillCascade"), Cases);
+    return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FMinesweeperRebuildGridBenchmark, "Minesweeper.Performance.RebuildGrid",
+    EAutomationTestFlags::EditorContext | EAutomationTestFlags::PerfFilter)
+
+bool FMinesweeperRebuildGridBenchmark::RunTest(const FString& Parameters)
+{
+    using namespace MinesweeperBench;
+
+    if (!FSlateApplication::IsInitialized())
+    {
+        AddWarning(TEXT("Slate is not initialized; skipping the board rebuild benchmark"));
+        return true;
+    }
+
+    // SMinesweeperWidget::RebuildGrid forwards to the board's RefreshBoard; time that, the prepass it triggers and the
+    // first paint of the new board into a window's element list, which is where the per-tile work happens
+    TArray<FCase> Cases;
+    for (const FIntPoint Size : Sizes)
+    {
+        FCase& Case = Cases.AddDefaulted_GetRef();
+        Case.Name = TEXT("RebuildGrid");
+        Case.Width = Size.X;
+        Case.Height = Size.Y;
+        Case.Bombs = FMath::FloorToInt(Size.X * Size.Y * 0.12f);
+
+        // Every other row under the viewport is clicked open, so the paint draws both tile faces and the numbers
+        FMinesweeperGameLogic Game;
+        TArray<int32> Changed;
+        TSharedRef<SMinesweeperBoard> Board = SNew(SMinesweeperBoard).Game(&Game);
+        TSharedRef<SWindow> Window = SNew(SWindow).ClientSize(FVector2D(1024.f, 768.f))[Board];
+        FHittestGrid HittestGrid;
+        Measure(Case, IterationsFor(Size),
+            [&](int32 i)
+            {
+                bool bHitBomb = false;
+                Game.NewGame(Case.Width, Case.Height, Case.Bombs, FixedSeed + i);
+                Game.PlaceBombsAround(0, 0);
+                for (int32 y = 0; y < FMath::Min(Case.Height, 64) && !bHitBomb; y += 2)
+                {
+                    for (int32 x = 0; x < FMath::Min(Case.Width, 64) && !bHitBomb; ++x)
+                    {
+                        if (!Game.Get(x, y).bIsBomb) Game.Click(x, y, bHitBomb, Changed);
+                    }
+                }
+            },
+            [&](int32)
+            {
+                Board->RefreshBoard();
+                Board->SlatePrepass(1.f);
+
+                FSlateWindowElementList DrawElements(Window);
+                const FGeometry Geometry = FGeometry::MakeRoot(Board->GetDesiredSize(), FSlateLayoutTransform());
+                const FPaintArgs PaintArgs(&Window.Get(), HittestGrid, FVector2D::ZeroVector, FApp::GetCurrentTime(), FApp::GetDeltaTime());
+                Board->Paint(PaintArgs, Geometry, Geometry.GetLayoutBoundingRect(), DrawElements, 0, FWidgetStyle(), true);
+            });
+    }
+
+    Report(*this, TEXT("RebuildGrid"), Cases);
+    return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
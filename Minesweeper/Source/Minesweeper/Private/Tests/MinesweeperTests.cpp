@@ -0,0 +1,1583 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "CoreMinimal.h"
+#include "Misc/AutomationTest.h"
+#include "Serialization/MemoryWriter.h"
+#include "Serialization/MemoryReader.h"
+#include "Async/ParallelFor.h"
+#include "Async/Async.h"
+#include "MinesweeperGameLogic.h"
+#include "MinesweeperChunkedBoard.h"
+#include "MinesweeperReplay.h"
+#include "MinesweeperSolver.h"
+#include "MinesweeperProbability.h"
+#include "MinesweeperVarInt.h"
+#include "MinesweeperCounterRng.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+// Run headless with e.g.
+//   UnrealEditor-Cmd <Project> -nullrhi -unattended -ExecCmds="Automation RunTests Minesweeper.Logic+Minesweeper.Generation; Quit"
+
+namespace MinesweeperTest
+{
+    const EMinesweeperTopology Topologies[] = { EMinesweeperTopology::Square, EMinesweeperTopology::Hex, EMinesweeperTopology::Torus };
+
+    // Fails Test on the first tile or counter where the two games differ; What names the comparison in the log
+    bool TestSameBoard(FAutomationTestBase& Test, const FString& What, const FMinesweeperGameLogic& A, const FMinesweeperGameLogic& B)
+    {
+        if (A.GetWidth() != B.GetWidth() || A.GetHeight() != B.GetHeight())
+        {
+            Test.AddError(FString::Printf(TEXT("%s: board size %dx%d vs %dx%d"), *What, A.GetWidth(), A.GetHeight(), B.GetWidth(), B.GetHeight()));
+            return false;
+        }
+        for (int32 Index = 0; Index < A.GetWidth() * A.GetHeight(); ++Index)
+        {
+            const FMSPTile& TileA = A.GetByIndex(Index);
+            const FMSPTile& TileB = B.GetByIndex(Index);
+            if (TileA.bIsBomb != TileB.bIsBomb || TileA.bRevealed != TileB.bRevealed || TileA.bFlagged != TileB.bFlagged
+                || (!TileA.bIsBomb && TileA.Adjacent != TileB.Adjacent))
+            {
+                Test.AddError(FString::Printf(TEXT("%s: tile %d differs (bomb %d/%d, revealed %d/%d, flagged %d/%d, adjacent %d/%d)"), *What, Index,
+                    TileA.bIsBomb, TileB.bIsBomb, TileA.bRevealed, TileB.bRevealed, TileA.bFlagged, TileB.bFlagged, TileA.Adjacent, TileB.Adjacent));
+                return false;
+            }
+        }
+        bool bSame = true;
+        bSame &= Test.TestEqual(What + TEXT(": bombs"), A.GetNumBombs(), B.GetNumBombs());
+        bSame &= Test.TestEqual(What + TEXT(": safe tiles left"), A.GetSafeTilesLeft(), B.GetSafeTilesLeft());
+        bSame &= Test.TestEqual(What + TEXT(": flags placed"), A.GetFlagsPlaced(), B.GetFlagsPlaced());
+        bSame &= Test.TestEqual(What + TEXT(": game over"), A.IsGameOver(), B.IsGameOver());
+        bSame &= Test.TestEqual(What + TEXT(": won"), A.IsWon(), B.IsWon());
+        return bSame;
+    }
+
+    // Plays one random move that cannot hit a bomb: a reveal of a safe tile, a flag (sometimes a wrong one) or a chord
+    // whose flags are all right. Appends it to Replay if given; returns false if the move changed nothing.
+    bool PlaySafeMove(FMinesweeperGameLogic& Game, FRandomStream& Rng, FMinesweeperReplay* Replay = nullptr)
+    {
+        const int32 X = Rng.RandRange(0, Game.GetWidth() - 1);
+        const int32 Y = Rng.RandRange(0, Game.GetHeight() - 1);
+        const FMSPTile& Tile = Game.Get(X, Y);
+        TArray<int32> Changed;
+        bool bHitBomb = false;
+
+        EMinesweeperMoveKind Kind = EMinesweeperMoveKind::Reveal;
+        if (!Game.HasPlacedBombs() || (!Tile.bRevealed && !Tile.bIsBomb && !Tile.bFlagged && Rng.FRand() < 0.6f))
+        {
+            Game.Click(X, Y, bHitBomb, Changed);
+        }
+        else if (!Tile.bRevealed)
+        {
+            Kind = EMinesweeperMoveKind::Flag;
+            Game.ToggleFlag(X, Y, Changed);
+        }
+        else
+        {
+            bool bFlagsRight = true;
+            Game.GetTopology().ForEachNeighbour(Game.ToIndex(X, Y), [&Game, &bFlagsRight](int32 N)
+            {
+                const FMSPTile& Neighbour = Game.GetByIndex(N);
+                bFlagsRight &= !Neighbour.bFlagged || Neighbour.bIsBomb;
+            });
+            if (!bFlagsRight) return false;
+            Kind = EMinesweeperMoveKind::Chord;
+            Game.Chord(X, Y, bHitBomb, Changed);
+        }
+        check(!bHitBomb);
+
+        if (Changed.Num() == 0) return false;
+        if (Replay)
+        {
+            FMinesweeperReplayMove& Move = Replay->Moves.AddDefaulted_GetRef();
+            Move.X = X;
+            Move.Y = Y;
+            Move.TimeMs = Replay->Moves.Num() * 250;
+            Move.Kind = Kind;
+        }
+        return true;
+    }
+
+    // Plays NumMoves moves that changed something, or until the game is won
+    void PlaySafeMoves(FMinesweeperGameLogic& Game, FRandomStream& Rng, int32 NumMoves, FMinesweeperReplay* Replay = nullptr)
+    {
+        for (int32 Played = 0; Played < NumMoves && !Game.IsGameOver();)
+        {
+            if (PlaySafeMove(Game, Rng, Replay)) ++Played;
+        }
+    }
+
+    // Loses the game on its first unflagged bomb; returns the bomb's index
+    int32 ClickHiddenBomb(FMinesweeperGameLogic& Game)
+    {
+        for (int32 Index = 0; Index < Game.GetWidth() * Game.GetHeight(); ++Index)
+        {
+            const FMSPTile& Tile = Game.GetByIndex(Index);
+            if (Tile.bIsBomb && !Tile.bFlagged)
+            {
+                TArray<int32> Changed;
+                bool bHitBomb = false;
+                Game.Click(Index % Game.GetWidth(), Index / Game.GetWidth(), bHitBomb, Changed);
+                return Index;
+            }
+        }
+        return INDEX_NONE;
+    }
+
+    // Starts Game on a known layout and clicks each of Open once; returns every tile that opened
+    TArray<int32> OpenPosition(FAutomationTestBase& Test, FMinesweeperGameLogic& Game, int32 Width, int32 Height,
+        TArrayView<const int32> Bombs, TArrayView<const int32> Open)
+    {
+        TArray<int32> Opened;
+        if (!Test.TestTrue(TEXT("layout accepted"), Game.NewGameWithBombs(Width, Height, Bombs))) return Opened;
+
+        TArray<int32> Changed;
+        for (const int32 Index : Open)
+        {
+            bool bHitBomb = false;
+            Game.Click(Index % Width, Index / Width, bHitBomb, Changed);
+            Test.TestFalse(TEXT("opened a bomb"), bHitBomb);
+            Opened.Append(Changed);
+        }
+        return Opened;
+    }
+
+    // Fails Test unless Solver knows exactly Mines as mines and Safe as safe, and nothing else
+    void TestDeductions(FAutomationTestBase& Test, const FString& What, const FMinesweeperSolver& Solver, int32 NumTiles,
+        TArrayView<const int32> Mines, TArrayView<const int32> Safe)
+    {
+        for (int32 Index = 0; Index < NumTiles; ++Index)
+        {
+            Test.TestEqual(What + FString::Printf(TEXT(": tile %d known mine"), Index), Solver.IsKnownMine(Index), Mines.Contains(Index));
+            Test.TestEqual(What + FString::Printf(TEXT(": tile %d known safe"), Index), Solver.IsKnownSafe(Index), Safe.Contains(Index));
+        }
+    }
+
+    // Fails Test unless every tile that differs between Before and After is listed in Changed
+    bool TestChangedCovers(FAutomationTestBase& Test, const FString& What, const FMinesweeperGameLogic& Before, const FMinesweeperGameLogic& After,
+        TArrayView<const int32> Changed)
+    {
+        for (int32 Index = 0; Index < Before.GetWidth() * Before.GetHeight(); ++Index)
+        {
+            const FMSPTile& TileBefore = Before.GetByIndex(Index);
+            const FMSPTile& TileAfter = After.GetByIndex(Index);
+            if ((TileBefore.bRevealed != TileAfter.bRevealed || TileBefore.bFlagged != TileAfter.bFlagged) && !Changed.Contains(Index))
+            {
+                Test.AddError(FString::Printf(TEXT("%s: tile %d changed but was not reported"), *What, Index));
+                return false;
+            }
+        }
+        return true;
+    }
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FMinesweeperSerializeTest, "Minesweeper.Logic.Serialize",
+    EAutomationTestFlags::EditorContext | EAutomationTestFlags::ProductFilter)
+
+bool FMinesweeperSerializeTest::RunTest(const FString& Parameters)
+{
+    using namespace MinesweeperTest;
+
+    for (const EMinesweeperTopology Kind : Topologies)
+    {
+        for (const EMinesweeperGenerator Generator : { EMinesweeperGenerator::Stream, EMinesweeperGenerator::Counter })
+        {
+            for (const int32 NumMoves : { 0, 1, 40 })
+            {
+                const FString What = FString::Printf(TEXT("topology %d, generator %d, %d moves"), int32(Kind), int32(Generator), NumMoves);
+
+                FMinesweeperGameLogic Saved;
+                Saved.SetTopology(Kind);
+                Saved.SetGenerator(Generator);
+                Saved.NewGame(24, 18, 60, 1234 + NumMoves);
+                FRandomStream Rng(NumMoves);
+                PlaySafeMoves(Saved, Rng, NumMoves);
+
+                TArray<uint8> Bytes;
+                FMemoryWriter Writer(Bytes);
+                Saved.Serialize(Writer);
+
+                FMinesweeperGameLogic Loaded;
+                FMemoryReader Reader(Bytes);
+                Loaded.Serialize(Reader);
+                if (!TestFalse(What + TEXT(": load error"), Reader.IsError())) continue;
+                TestTrue(What + TEXT(": whole save read"), Reader.AtEnd());
+
+                TestSameBoard(*this, What, Saved, Loaded);
+                TestEqual(What + TEXT(": seed"), Loaded.GetSeed(), Saved.GetSeed());
+                TestEqual(What + TEXT(": topology"), Loaded.GetTopology().GetKind(), Kind);
+                TestEqual(What + TEXT(": generator"), Loaded.GetGenerator(), Generator);
+                TestEqual(What + TEXT(": bombs placed"), Loaded.HasPlacedBombs(), Saved.HasPlacedBombs());
+
+                // A game saved before its first click must still get the same bombs from it
+                if (!Saved.HasPlacedBombs())
+                {
+                    TArray<int32> Changed;
+                    bool bHitBomb = false;
+                    Saved.Click(5, 7, bHitBomb, Changed);
+                    Loaded.Click(5, 7, bHitBomb, Changed);
+                    TestSameBoard(*this, What + TEXT(", first click after load"), Saved, Loaded);
+                }
+            }
+        }
+    }
+
+    // Loading into a game of another topology, the same size as the save, takes the saved topology's neighbours
+    {
+        constexpr int32 W = 24, H = 18;
+        TArray<int32> RingOffsets, RingNeighbours;
+        for (int32 i = 0; i < W * H; ++i)
+        {
+            RingOffsets.Add(RingNeighbours.Num());
+            RingNeighbours.Add((i + W * H - 1) % (W * H));
+            RingNeighbours.Add((i + 1) % (W * H));
+        }
+        RingOffsets.Add(RingNeighbours.Num());
+        FMinesweeperTopology Ring;
+        TestTrue(TEXT("ring graph made"), FMinesweeperTopology::MakeGraph(W, H, RingOffsets, RingNeighbours, Ring));
+
+        TArray<FMinesweeperTopology> Targets = { Ring };
+        for (const EMinesweeperTopology Kind : Topologies)
+        {
+            Targets.Add(FMinesweeperTopology(Kind));
+        }
+
+        for (const EMinesweeperTopology Kind : Topologies)
+        {
+            FMinesweeperGameLogic Saved;
+            Saved.SetTopology(Kind);
+            Saved.NewGame(W, H, 60, 4321);
+            FRandomStream Rng(int32(Kind));
+            PlaySafeMoves(Saved, Rng, 10);
+
+            TArray<uint8> Bytes;
+            FMemoryWriter Writer(Bytes);
+            Saved.Serialize(Writer);
+
+            for (const FMinesweeperTopology& Target : Targets)
+            {
+                const FString What = FString::Printf(TEXT("topology %d loaded over topology %d"), int32(Kind), int32(Target.GetKind()));
+                FMinesweeperGameLogic Loaded;
+                Loaded.SetTopology(Target);
+                Loaded.NewGame(W, H, 60, 99);
+
+                FMemoryReader Reader(Bytes);
+                Loaded.Serialize(Reader);
+                if (!TestFalse(What + TEXT(": load error"), Reader.IsError())) continue;
+                TestEqual(What + TEXT(": topology"), Loaded.GetTopology().GetKind(), Kind);
+                TestSameBoard(*this, What, Saved, Loaded);
+
+                int32 Mismatches = 0;
+                for (int32 Index = 0; Index < W * H; ++Index)
+                {
+                    TArray<int32> Expected, Actual;
+                    Saved.GetTopology().ForEachNeighbour(Index, [&Expected](int32 N) { Expected.Add(N); });
+                    Loaded.GetTopology().ForEachNeighbour(Index, [&Actual](int32 N) { Actual.Add(N); });
+                    Mismatches += Expected != Actual;
+                }
+                TestEqual(What + TEXT(": tiles with other neighbours"), Mismatches, 0);
+            }
+        }
+    }
+
+    // Saves of any other version are refused
+    {
+        FMinesweeperGameLogic Saved;
+        Saved.NewGame(8, 8, 10, 99);
+        TArray<uint8> Bytes;
+        FMemoryWriter Writer(Bytes);
+        Saved.Serialize(Writer);
+        Bytes[0] ^= 0x01;
+
+        FMinesweeperGameLogic Loaded;
+        FMemoryReader Reader(Bytes);
+        Loaded.Serialize(Reader);
+        TestTrue(TEXT("other version refused"), Reader.IsError());
+    }
+    return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FMinesweeperAdjacencyTest, "Minesweeper.Logic.Adjacency",
+    EAutomationTestFlags::EditorContext | EAutomationTestFlags::ProductFilter)
+
+bool FMinesweeperAdjacencyTest::RunTest(const FString& Parameters)
+{
+    // Widths either side of the 64-bit word edges, single rows and columns, and the fixed-size presets
+    const FIntPoint SquareSizes[] = { {63, 5}, {64, 7}, {65, 9}, {127, 3}, {128, 4}, {129, 11}, {150, 1}, {1, 150}, {2, 2}, {9, 9}, {30, 16} };
+    const FIntPoint TorusSizes[] = { {64, 8}, {65, 9}, {3, 3}, {4, 70} };
+
+    for (const EMinesweeperTopology Kind : { EMinesweeperTopology::Square, EMinesweeperTopology::Torus })
+    {
+        const bool bWrap = Kind == EMinesweeperTopology::Torus;
+        for (const FIntPoint Size : bWrap ? MakeArrayView(TorusSizes) : MakeArrayView(SquareSizes))
+        {
+            const int32 NumTiles = Size.X * Size.Y;
+            // Dense enough that word and row edges see every count, up to a board that is all bombs but one tile
+            for (const int32 Bombs : { NumTiles / 3, NumTiles / 2, NumTiles - 1 })
+            {
+                for (int32 Seed = 0; Seed < 3; ++Seed)
+                {
+                    const FString What = FString::Printf(TEXT("topology %d, %dx%d with %d bombs, seed %d"), int32(Kind), Size.X, Size.Y, Bombs, Seed);
+
+                    FMinesweeperGameLogic Game;
+                    Game.SetTopology(Kind);
+                    Game.NewGame(Size.X, Size.Y, Bombs, 31 * Seed + 1);
+                    Game.PlaceBombsAround(Seed % Size.X, (Seed * 7) % Size.Y);
+
+                    // Naive count by coordinates, independent of the topology's tables
+                    int32 Mismatches = 0, FirstMismatch = INDEX_NONE;
+                    for (int32 y = 0; y < Size.Y; ++y)
+                    {
+                        for (int32 x = 0; x < Size.X; ++x)
+                        {
+                            const FMSPTile& Tile = Game.Get(x, y);
+                            if (Tile.bIsBomb) continue;
+
+                            // A side shorter than three wraps onto the same tile twice; the torus counts it once
+                            TArray<int32, TInlineAllocator<8>> Seen;
+                            int32 Count = 0;
+                            for (int32 dy = -1; dy <= 1; ++dy)
+                            {
+                                for (int32 dx = -1; dx <= 1; ++dx)
+                                {
+                                    int32 nx = x + dx, ny = y + dy;
+                                    if (bWrap)
+                                    {
+                                        nx = (nx + Size.X) % Size.X;
+                                        ny = (ny + Size.Y) % Size.Y;
+                                    }
+                                    else if (nx < 0 || nx >= Size.X || ny < 0 || ny >= Size.Y)
+                                    {
+                                        continue;
+                                    }
+                                    const int32 N = ny * Size.X + nx;
+                                    if ((nx == x && ny == y) || Seen.Contains(N)) continue;
+                                    Seen.Add(N);
+                                    Count += Game.GetByIndex(N).bIsBomb;
+                                }
+                            }
+                            if (Count != Tile.Adjacent)
+                            {
+                                if (Mismatches++ == 0) FirstMismatch = y * Size.X + x;
+                            }
+                        }
+                    }
+                    if (!TestEqual(What + TEXT(": counts off the naive count"), Mismatches, 0))
+                    {
+                        AddInfo(FString::Printf(TEXT("%s: first at tile %d"), *What, FirstMismatch));
+                    }
+                }
+            }
+        }
+    }
+    return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FMinesweeperFloodFillTest, "Minesweeper.Logic.FloodFill",
+    EAutomationTestFlags::EditorContext | EAutomationTestFlags::ProductFilter)
+
+bool FMinesweeperFloodFillTest::RunTest(const FString& Parameters)
+{
+    using namespace MinesweeperTest;
+
+    struct FFillCase
+    {
+        EMinesweeperTopology Kind;
+        int32 Width;
+        int32 Height;
+        float Density;
+    };
+    // Wide open square boards take the scanline fill, 30x16 its fixed-size kernel, hex and torus (with its wrap) the
+    // neighbour fill
+    const FFillCase Cases[] = {
+        { EMinesweeperTopology::Square, 200, 150, 0.f },
+        { EMinesweeperTopology::Square, 200, 150, 0.03f },
+        { EMinesweeperTopology::Square, 131, 67, 0.1f },
+        { EMinesweeperTopology::Square, 30, 16, 0.06f },
+        { EMinesweeperTopology::Hex, 60, 40, 0.05f },
+        { EMinesweeperTopology::Torus, 60, 40, 0.f },
+        { EMinesweeperTopology::Torus, 60, 40, 0.04f },
+    };
+
+    for (const FFillCase& Case : Cases)
+    {
+        for (int32 Round = 0; Round < 4; ++Round)
+        {
+            const FString What = FString::Printf(TEXT("topology %d, %dx%d at %.2f, round %d"), int32(Case.Kind), Case.Width, Case.Height, Case.Density, Round);
+            const int32 NumTiles = Case.Width * Case.Height;
+
+            FMinesweeperGameLogic Game;
+            Game.SetTopology(Case.Kind);
+            Game.NewGame(Case.Width, Case.Height, FMath::FloorToInt(NumTiles * Case.Density), 700 + Round);
+            FRandomStream Rng(Round);
+            // On the torus, a start on the edge makes the first cascade wrap
+            const int32 StartX = Case.Kind == EMinesweeperTopology::Torus ? 0 : Rng.RandRange(0, Case.Width - 1);
+            const int32 StartY = Rng.RandRange(0, Case.Height - 1);
+            Game.PlaceBombsAround(StartX, StartY);
+
+            // Flags on bombs and on safe tiles alike; a cascade opens through the wrong ones
+            TArray<int32> Changed;
+            for (int32 Index = 0; Index < NumTiles; ++Index)
+            {
+                if (Index != Game.ToIndex(StartX, StartY) && Rng.FRand() < 0.04f) Game.ToggleFlag(Index % Case.Width, Index / Case.Width, Changed);
+            }
+
+            for (int32 ClickNum = 0; ClickNum < 6 && !Game.IsGameOver(); ++ClickNum)
+            {
+                int32 Start = Game.ToIndex(StartX, StartY);
+                for (int32 Try = 0; ClickNum > 0 && Try < 1000; ++Try)
+                {
+                    const FMSPTile& T = Game.GetByIndex(Start = Rng.RandRange(0, NumTiles - 1));
+                    if (!T.bRevealed && !T.bFlagged && !T.bIsBomb) break;
+                }
+                const FMSPTile& StartTile = Game.GetByIndex(Start);
+                if (StartTile.bRevealed || StartTile.bFlagged || StartTile.bIsBomb) break;
+
+                // Reference: breadth-first through zeros over the topology, from what was revealed before the click
+                TArray<bool> Expected;
+                Expected.SetNumUninitialized(NumTiles);
+                for (int32 Index = 0; Index < NumTiles; ++Index)
+                {
+                    Expected[Index] = Game.GetByIndex(Index).bRevealed != 0;
+                }
+                TArray<int32> Queue = { Start };
+                Expected[Start] = true;
+                for (int32 Head = 0; Head < Queue.Num(); ++Head)
+                {
+                    if (Game.GetByIndex(Queue[Head]).Adjacent != 0) continue;
+                    Game.GetTopology().ForEachNeighbour(Queue[Head], [&Expected, &Queue](int32 N)
+                    {
+                        if (Expected[N]) return;
+                        Expected[N] = true;
+                        Queue.Add(N);
+                    });
+                }
+
+                bool bHitBomb = false;
+                Game.Click(Start % Case.Width, Start / Case.Width, bHitBomb, Changed);
+                TestFalse(What + TEXT(": bomb hit"), bHitBomb);
+
+                // Changed lists each newly revealed tile once, and those are exactly the reference's
+                TArray<int32> Sorted = Changed;
+                Sorted.Sort();
+                TestEqual(What + TEXT(": tiles reported"), Sorted.Num(), Queue.Num());
+                for (int32 i = 0; i < FMath::Min(Sorted.Num(), Queue.Num()); ++i)
+                {
+                    if (i > 0 && Sorted[i] == Sorted[i - 1])
+                    {
+                        AddError(FString::Printf(TEXT("%s: tile %d reported twice"), *What, Sorted[i]));
+                        break;
+                    }
+                }
+
+                int32 Mismatches = 0, Flags = 0;
+                for (int32 Index = 0; Index < NumTiles; ++Index)
+                {
+                    const FMSPTile& T = Game.GetByIndex(Index);
+                    Mismatches += (T.bRevealed != 0) != Expected[Index] || (T.bRevealed && T.bFlagged);
+                    Flags += T.bFlagged;
+                }
+                TestEqual(What + TEXT(": tiles off the reference fill, or revealed with a flag"), Mismatches, 0);
+                TestEqual(What + TEXT(": flags placed"), Game.GetFlagsPlaced(), Flags);
+            }
+        }
+    }
+    return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FMinesweeperEndlessBoardTest, "Minesweeper.Logic.EndlessBoard",
+    EAutomationTestFlags::EditorContext | EAutomationTestFlags::ProductFilter)
+
+bool FMinesweeperEndlessBoardTest::RunTest(const FString& Parameters)
+{
+    constexpr int32 Size = FMinesweeperChunkedBoard::ChunkSize;
+    constexpr int32 BombsPerChunk = Size * Size / 5;
+    constexpr int32 Seed = 5150;
+
+    // On a chunk corner at negative coordinates, so the cascade and the first click's clearing cross chunk edges.
+    // Checks run on Inner, whose neighbours all lie in Region.
+    const FIntPoint Start(-Size, 0);
+    const FIntRect Region(Start.X - 3 * Size, Start.Y - 3 * Size, Start.X + 3 * Size, Start.Y + 3 * Size);
+    const FIntRect Inner(Start.X - 2 * Size, Start.Y - 2 * Size, Start.X + 2 * Size, Start.Y + 2 * Size);
+
+    auto ForEachTile = [](const FIntRect& Rect, auto&& Func)
+    {
+        for (int32 y = Rect.Min.Y; y < Rect.Max.Y; ++y)
+        {
+            for (int32 x = Rect.Min.X; x < Rect.Max.X; ++x)
+            {
+                Func(x, y);
+            }
+        }
+    };
+    auto ForEachNeighbour = [](int32 X, int32 Y, auto&& Func)
+    {
+        for (int32 dy = -1; dy <= 1; ++dy)
+        {
+            for (int32 dx = -1; dx <= 1; ++dx)
+            {
+                if (dx | dy) Func(X + dx, Y + dy);
+            }
+        }
+    };
+    // What the player sees of Inner
+    auto Snapshot = [&ForEachTile, &Inner](const FMinesweeperChunkedBoard& Board)
+    {
+        TArray<uint8> Seen;
+        ForEachTile(Inner, [&Board, &Seen](int32 X, int32 Y)
+        {
+            const FMSPTile T = Board.Get(X, Y);
+            Seen.Add(uint8(T.bRevealed) | uint8(T.bFlagged) << 1 | uint8(T.bRevealed ? T.Adjacent : 0) << 2);
+        });
+        return Seen;
+    };
+
+    TArray<FIntPoint> Changed;
+    bool bHitBomb = false;
+    auto StartGame = [&](FMinesweeperChunkedBoard& Board, int32 MaxCascadeTiles)
+    {
+        Board.NewGame(BombsPerChunk, Seed);
+        Board.SetMaxCascadeTiles(MaxCascadeTiles);
+        Board.Click(Start.X, Start.Y, bHitBomb, Changed);
+        Board.PageTo(Region);
+    };
+
+    // The first click is safe and opens its neighbourhood
+    FMinesweeperChunkedBoard Reference;
+    StartGame(Reference, MAX_int32);
+    TestFalse(TEXT("first click hits a bomb"), bHitBomb);
+    TestTrue(TEXT("first click opens a cascade"), Changed.Num() >= 9);
+    ForEachNeighbour(Start.X, Start.Y, [this, &Reference](int32 X, int32 Y)
+    {
+        TestTrue(FString::Printf(TEXT("start neighbour (%d, %d) revealed"), X, Y), Reference.Get(X, Y).bRevealed && !Reference.Get(X, Y).bIsBomb);
+    });
+
+    // Every open zero has its neighbours open
+    ForEachTile(Inner, [&](int32 X, int32 Y)
+    {
+        const FMSPTile T = Reference.Get(X, Y);
+        if (!T.bRevealed || T.bIsBomb || T.Adjacent != 0) return;
+        ForEachNeighbour(X, Y, [&](int32 NX, int32 NY)
+        {
+            if (!Reference.Get(NX, NY).bRevealed) AddError(FString::Printf(TEXT("open zero (%d, %d) next to hidden (%d, %d)"), X, Y, NX, NY));
+        });
+    });
+
+    // A flag placed before the first click does not change the layout
+    {
+        FMinesweeperChunkedBoard Flagged;
+        Flagged.NewGame(BombsPerChunk, Seed);
+        Flagged.ToggleFlag(Start.X + 2, Start.Y + 2, Changed);
+        Flagged.Click(Start.X, Start.Y, bHitBomb, Changed);
+        Flagged.PageTo(Region);
+        int32 Mismatches = 0;
+        ForEachTile(Inner, [&](int32 X, int32 Y)
+        {
+            const FMSPTile A = Flagged.Get(X, Y);
+            const FMSPTile B = Reference.Get(X, Y);
+            Mismatches += A.bRevealed != B.bRevealed || (A.bRevealed && A.Adjacent != B.Adjacent);
+        });
+        TestEqual(TEXT("tiles changed by an early flag"), Mismatches, 0);
+    }
+
+    // A capped cascade continued by clicks on the zeros it left hidden ends where the uncapped one did
+    {
+        FMinesweeperChunkedBoard Capped;
+        StartGame(Capped, 16);
+        for (int32 Round = 0; Round < 100000; ++Round)
+        {
+            FIntPoint Next(MAX_int32, MAX_int32);
+            ForEachTile(Inner, [&](int32 X, int32 Y)
+            {
+                const FMSPTile T = Capped.Get(X, Y);
+                if (Next.X != MAX_int32 || T.bRevealed || T.bIsBomb || T.Adjacent != 0) return;
+                ForEachNeighbour(X, Y, [&](int32 NX, int32 NY)
+                {
+                    const FMSPTile N = Capped.Get(NX, NY);
+                    if (N.bRevealed && N.Adjacent == 0) Next = FIntPoint(X, Y);
+                });
+            });
+            if (Next.X == MAX_int32) break;
+            Capped.Click(Next.X, Next.Y, bHitBomb, Changed);
+            Capped.PageTo(Region);
+        }
+        TestTrue(TEXT("capped cascade continued to the uncapped one"), Snapshot(Capped) == Snapshot(Reference));
+    }
+
+    // Paging out keeps only the marks, and paging back in restores exactly what was seen
+    {
+        ForEachTile(Inner, [&](int32 X, int32 Y)
+        {
+            if (Reference.GetFlagsPlaced() == 0 && !Reference.Get(X, Y).bRevealed) Reference.ToggleFlag(X, Y, Changed);
+        });
+        TestEqual(TEXT("flags placed"), Reference.GetFlagsPlaced(), 1);
+        Reference.PageTo(Region);
+        const TArray<uint8> Before = Snapshot(Reference);
+
+        const int32 Far = 1 << 24;
+        TestFalse(TEXT("paging to untouched tiles pages nothing in"), Reference.PageTo(FIntRect(Far, Far, Far + 8, Far + 8)));
+        TestEqual(TEXT("chunks left resident"), Reference.GetNumChunks(), 0);
+        TestTrue(TEXT("chunks kept as marks"), Reference.GetNumPagedOutChunks() > 0);
+        TestFalse(TEXT("paged out tile reads hidden"), Reference.Get(Start.X, Start.Y).bRevealed);
+
+        TestTrue(TEXT("paging back in"), Reference.PageTo(Region));
+        TestEqual(TEXT("chunks still paged out"), Reference.GetNumPagedOutChunks(), 0);
+        TestTrue(TEXT("paged back in as seen"), Snapshot(Reference) == Before);
+    }
+
+    // A correct chord opens the rest of the neighbourhood; one with a wrong flag hits a bomb
+    for (const bool bWrongFlag : { false, true })
+    {
+        const FString What = bWrongFlag ? TEXT("chord with a wrong flag") : TEXT("chord");
+        FMinesweeperChunkedBoard Board;
+        StartGame(Board, MAX_int32);
+
+        // A revealed number whose neighbours all lie in its own chunk, which is resident, so Get shows their bombs
+        FIntPoint Target(MAX_int32, MAX_int32);
+        TArray<FIntPoint> ToFlag;
+        ForEachTile(Inner, [&](int32 X, int32 Y)
+        {
+            const FMSPTile T = Board.Get(X, Y);
+            const int32 LX = X & (Size - 1), LY = Y & (Size - 1);
+            if (Target.X != MAX_int32 || !T.bRevealed || T.Adjacent == 0 || LX == 0 || LX == Size - 1 || LY == 0 || LY == Size - 1) return;
+
+            TArray<FIntPoint> Bombs, Safe;
+            ForEachNeighbour(X, Y, [&](int32 NX, int32 NY)
+            {
+                const FMSPTile N = Board.Get(NX, NY);
+                if (!N.bRevealed) (N.bIsBomb ? Bombs : Safe).Add(FIntPoint(NX, NY));
+            });
+            if (bWrongFlag ? Safe.Num() < T.Adjacent : Safe.Num() == 0) return;
+            Target = FIntPoint(X, Y);
+            ToFlag = bWrongFlag ? TArray<FIntPoint>(Safe.GetData(), T.Adjacent) : Bombs;
+        });
+        if (!TestTrue(What + TEXT(": found a tile to chord"), Target.X != MAX_int32)) continue;
+
+        for (const FIntPoint& Tile : ToFlag)
+        {
+            Board.ToggleFlag(Tile.X, Tile.Y, Changed);
+        }
+        Board.Chord(Target.X, Target.Y, bHitBomb, Changed);
+        TestEqual(What + TEXT(": bomb hit"), bHitBomb, bWrongFlag);
+        TestEqual(What + TEXT(": game over"), Board.IsGameOver(), bWrongFlag);
+        if (!bWrongFlag)
+        {
+            TestTrue(What + TEXT(": opened tiles"), Changed.Num() > 0);
+            ForEachNeighbour(Target.X, Target.Y, [&](int32 NX, int32 NY)
+            {
+                const FMSPTile N = Board.Get(NX, NY);
+                TestTrue(What + TEXT(": neighbour open or flagged"), N.bRevealed || N.bFlagged);
+            });
+        }
+    }
+
+    // Lost, every chunk in view pages in; adjacency matches a plain count across chunk edges and the start stays clear
+    {
+        FIntPoint Bomb(MAX_int32, MAX_int32);
+        ForEachTile(Inner, [&](int32 X, int32 Y)
+        {
+            const FMSPTile T = Reference.Get(X, Y);
+            if (Bomb.X == MAX_int32 && T.bIsBomb && !T.bFlagged) Bomb = FIntPoint(X, Y);
+        });
+        if (TestTrue(TEXT("found a bomb"), Bomb.X != MAX_int32))
+        {
+            Reference.Click(Bomb.X, Bomb.Y, bHitBomb, Changed);
+            TestTrue(TEXT("bomb hit"), bHitBomb && Reference.IsGameOver());
+            Reference.PageTo(Region);
+
+            int32 Mismatches = 0;
+            ForEachTile(Inner, [&](int32 X, int32 Y)
+            {
+                const FMSPTile T = Reference.Get(X, Y);
+                if (T.bIsBomb)
+                {
+                    Mismatches += !T.bRevealed;
+                    return;
+                }
+                int32 Count = 0;
+                ForEachNeighbour(X, Y, [&](int32 NX, int32 NY) { Count += Reference.Get(NX, NY).bIsBomb; });
+                Mismatches += Count != T.Adjacent;
+            });
+            TestEqual(TEXT("tiles off a plain count, or bombs not shown"), Mismatches, 0);
+            TestEqual(TEXT("bombs around the first click"), Reference.Get(Start.X, Start.Y).Adjacent, 0);
+        }
+    }
+    return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FMinesweeperUndoRedoTest, "Minesweeper.Logic.UndoRedo",
+    EAutomationTestFlags::EditorContext | EAutomationTestFlags::ProductFilter)
+
+bool FMinesweeperUndoRedoTest::RunTest(const FString& Parameters)
+{
+    using namespace MinesweeperTest;
+
+    for (const EMinesweeperTopology Kind : Topologies)
+    {
+        const FString What = FString::Printf(TEXT("topology %d"), int32(Kind));
+
+        FMinesweeperGameLogic Game;
+        Game.SetTopology(Kind);
+        Game.NewGame(20, 16, 50, 4321);
+        // Bomb placement is never undone, so place the bombs before the first snapshot
+        Game.PlaceBombsAround(10, 8);
+
+        // History[i] is the game after i moves; the last move loses
+        TArray<FMinesweeperGameLogic> History;
+        History.Add(Game);
+        FRandomStream Rng(7);
+        for (int32 Move = 0; Move < 30 && !Game.IsGameOver(); ++Move)
+        {
+            PlaySafeMoves(Game, Rng, 1);
+            History.Add(Game);
+        }
+        if (!Game.IsGameOver())
+        {
+            ClickHiddenBomb(Game);
+            TestTrue(What + TEXT(": losing click ends the game"), Game.IsGameOver() && !Game.IsWon());
+            History.Add(Game);
+        }
+
+        TArray<int32> Changed;
+        for (int32 Step = History.Num() - 2; Step >= 0; --Step)
+        {
+            const FMinesweeperGameLogic Before = Game;
+            if (!TestTrue(What + TEXT(": can undo"), Game.Undo(Changed))) break;
+            const FString StepName = FString::Printf(TEXT("%s, undo to move %d"), *What, Step);
+            TestSameBoard(*this, StepName, History[Step], Game);
+            TestChangedCovers(*this, StepName, Before, Game, Changed);
+        }
+        TestFalse(What + TEXT(": nothing left to undo"), Game.CanUndo());
+
+        for (int32 Step = 1; Step < History.Num(); ++Step)
+        {
+            const FMinesweeperGameLogic Before = Game;
+            if (!TestTrue(What + TEXT(": can redo"), Game.Redo(Changed))) break;
+            const FString StepName = FString::Printf(TEXT("%s, redo to move %d"), *What, Step);
+            TestSameBoard(*this, StepName, History[Step], Game);
+            TestChangedCovers(*this, StepName, Before, Game, Changed);
+        }
+        TestFalse(What + TEXT(": nothing left to redo"), Game.CanRedo());
+
+        // A new move after an undo drops the moves that were undone
+        Game.Undo(Changed);
+        Game.Undo(Changed);
+        PlaySafeMoves(Game, Rng, 1);
+        TestFalse(What + TEXT(": new move drops redo"), Game.CanRedo());
+    }
+    return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FMinesweeperReplayTest, "Minesweeper.Logic.Replay",
+    EAutomationTestFlags::EditorContext | EAutomationTestFlags::ProductFilter)
+
+bool FMinesweeperReplayTest::RunTest(const FString& Parameters)
+{
+    using namespace MinesweeperTest;
+
+    for (const EMinesweeperTopology Kind : Topologies)
+    {
+        for (const EMinesweeperGenerator Generator : { EMinesweeperGenerator::Stream, EMinesweeperGenerator::Counter })
+        {
+            for (const bool bLose : { false, true })
+            {
+                const FString What = FString::Printf(TEXT("topology %d, generator %d%s"), int32(Kind), int32(Generator), bLose ? TEXT(", lost") : TEXT(""));
+
+                FMinesweeperReplay Recorded;
+                Recorded.Width = 22;
+                Recorded.Height = 17;
+                Recorded.Bombs = 55;
+                Recorded.Seed = -97531;
+                Recorded.Topology = Kind;
+                Recorded.Generator = Generator;
+
+                FMinesweeperGameLogic Live;
+                Live.SetTopology(Kind);
+                Live.SetGenerator(Generator);
+                Live.NewGame(Recorded.Width, Recorded.Height, Recorded.Bombs, Recorded.Seed);
+                FRandomStream Rng(int32(Kind) * 2 + int32(Generator));
+                PlaySafeMoves(Live, Rng, 60, &Recorded);
+                if (bLose && !Live.IsGameOver())
+                {
+                    const int32 Bomb = ClickHiddenBomb(Live);
+                    FMinesweeperReplayMove& Move = Recorded.Moves.AddDefaulted_GetRef();
+                    Move.X = Bomb % Live.GetWidth();
+                    Move.Y = Bomb / Live.GetWidth();
+                    Move.TimeMs = Recorded.Moves.Num() * 250;
+                }
+
+                TArray<uint8> Bytes;
+                Recorded.Encode(Bytes);
+                int32 Pos = 0;
+                uint32 PayloadBytes = 0;
+                if (!TestTrue(What + TEXT(": length prefix"), MinesweeperVarInt::ReadUInt(Bytes, Pos, PayloadBytes))) continue;
+                if (!TestEqual(What + TEXT(": record size"), Pos + int32(PayloadBytes), Bytes.Num())) continue;
+
+                FMinesweeperReplay Decoded;
+                if (!TestTrue(What + TEXT(": decodes"), Decoded.Decode(TArrayView<const uint8>(Bytes).Slice(Pos, int32(PayloadBytes))))) continue;
+                TestEqual(What + TEXT(": width"), Decoded.Width, Recorded.Width);
+                TestEqual(What + TEXT(": height"), Decoded.Height, Recorded.Height);
+                TestEqual(What + TEXT(": bombs"), Decoded.Bombs, Recorded.Bombs);
+                TestEqual(What + TEXT(": seed"), Decoded.Seed, Recorded.Seed);
+                TestEqual(What + TEXT(": topology"), Decoded.Topology, Recorded.Topology);
+                TestEqual(What + TEXT(": generator"), Decoded.Generator, Recorded.Generator);
+                if (!TestEqual(What + TEXT(": moves"), Decoded.Moves.Num(), Recorded.Moves.Num())) continue;
+                for (int32 i = 0; i < Decoded.Moves.Num(); ++i)
+                {
+                    const FMinesweeperReplayMove& A = Decoded.Moves[i];
+                    const FMinesweeperReplayMove& B = Recorded.Moves[i];
+                    if (A.X != B.X || A.Y != B.Y || A.TimeMs != B.TimeMs || A.Kind != B.Kind)
+                    {
+                        AddError(FString::Printf(TEXT("%s: move %d decodes differently"), *What, i));
+                        break;
+                    }
+                }
+
+                FMinesweeperGameLogic Replayed;
+                TArray<int32> Scratch;
+                const bool bHitBomb = Decoded.Play(Replayed, Scratch);
+                TestEqual(What + TEXT(": bomb hit"), bHitBomb, Live.IsGameOver() && !Live.IsWon());
+                TestSameBoard(*this, What, Live, Replayed);
+            }
+        }
+    }
+
+    // A truncated payload is rejected
+    FMinesweeperReplay Replay;
+    Replay.Width = 9;
+    Replay.Height = 9;
+    Replay.Bombs = 10;
+    Replay.Seed = 5;
+    Replay.Moves.AddDefaulted(3);
+    TArray<uint8> Bytes;
+    Replay.Encode(Bytes);
+    TestFalse(TEXT("truncated payload rejected"), Replay.Decode(TArrayView<const uint8>(Bytes).Slice(1, Bytes.Num() - 2)));
+
+    // So is a header no game could start from; the largest board the UI offers still decodes
+    const FIntVector Headers[] = {
+        { 0, 9, 0 }, { 9, 0, 0 }, { -1, 9, 10 }, { 9, -3, 10 },
+        { FMinesweeperGameLogic::MaxSide + 1, 9, 10 }, { 9, FMinesweeperGameLogic::MaxSide + 1, 10 }, { MAX_int32, MAX_int32, 10 },
+        { 9, 9, 81 }, { 9, 9, -1 }, { 1, 1, 1 },
+    };
+    for (const FIntVector& Header : Headers)
+    {
+        FMinesweeperReplay Malformed;
+        Malformed.Width = Header.X;
+        Malformed.Height = Header.Y;
+        Malformed.Bombs = Header.Z;
+        Bytes.Reset();
+        Malformed.Encode(Bytes);
+
+        int32 Pos = 0;
+        uint32 PayloadBytes = 0;
+        MinesweeperVarInt::ReadUInt(Bytes, Pos, PayloadBytes);
+        FMinesweeperReplay Decoded;
+        TestFalse(FString::Printf(TEXT("%dx%d with %d bombs rejected"), Header.X, Header.Y, Header.Z),
+            Decoded.Decode(TArrayView<const uint8>(Bytes).Slice(Pos, int32(PayloadBytes))));
+    }
+    {
+        FMinesweeperReplay Largest;
+        Largest.Width = FMinesweeperGameLogic::MaxSide;
+        Largest.Height = FMinesweeperGameLogic::MaxSide;
+        Largest.Bombs = Largest.Width * Largest.Height - 1;
+        Bytes.Reset();
+        Largest.Encode(Bytes);
+
+        int32 Pos = 0;
+        uint32 PayloadBytes = 0;
+        MinesweeperVarInt::ReadUInt(Bytes, Pos, PayloadBytes);
+        FMinesweeperReplay Decoded;
+        TestTrue(TEXT("largest board decodes"), Decoded.Decode(TArrayView<const uint8>(Bytes).Slice(Pos, int32(PayloadBytes))));
+    }
+    return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FMinesweeperClickManyTest, "Minesweeper.Logic.ClickMany",
+    EAutomationTestFlags::EditorContext | EAutomationTestFlags::ProductFilter)
+
+bool FMinesweeperClickManyTest::RunTest(const FString& Parameters)
+{
+    using namespace MinesweeperTest;
+
+    for (const EMinesweeperTopology Kind : Topologies)
+    {
+        for (int32 Case = 0; Case < 40; ++Case)
+        {
+            const bool bStopAtRevealed = Case % 2 == 1;
+            const FString What = FString::Printf(TEXT("topology %d, case %d"), int32(Kind), Case);
+
+            // Same board and moves on both; every fourth case starts before the first click
+            FMinesweeperGameLogic Batched;
+            Batched.SetTopology(Kind);
+            Batched.NewGame(16, 16, 40, 1000 + Case);
+            FMinesweeperGameLogic Sequential = Batched;
+            const int32 NumMoves = Case % 4 == 0 ? 0 : Case;
+            FRandomStream BatchedRng(Case), SequentialRng(Case);
+            PlaySafeMoves(Batched, BatchedRng, NumMoves);
+            PlaySafeMoves(Sequential, SequentialRng, NumMoves);
+
+            // Points may repeat, fall off the board or land on flags and bombs
+            FRandomStream PointRng(Case + 100);
+            TArray<FIntPoint> Points;
+            const int32 NumPoints = PointRng.RandRange(1, 24);
+            for (int32 i = 0; i < NumPoints; ++i)
+            {
+                const int32 X = PointRng.RandRange(-1, 16);
+                const int32 Y = PointRng.RandRange(0, 15);
+                Points.Add(FIntPoint(X, Y));
+            }
+
+            bool bBatchHitBomb = false;
+            TArray<int32> BatchChanged;
+            const int32 NumDone = Batched.ClickMany(Points, bBatchHitBomb, BatchChanged, bStopAtRevealed);
+
+            bool bSequentialHitBomb = false;
+            TSet<int32> SequentialChanged;
+            TArray<int32> Changed;
+            for (int32 i = 0; i < NumDone && !Sequential.IsGameOver(); ++i)
+            {
+                Sequential.Click(Points[i].X, Points[i].Y, bSequentialHitBomb, Changed);
+                SequentialChanged.Append(Changed);
+            }
+
+            if (bStopAtRevealed)
+            {
+                if (NumDone < Points.Num() && !Batched.IsGameOver())
+                {
+                    TestTrue(What + TEXT(": stopped on a revealed tile"), Batched.Get(Points[NumDone].X, Points[NumDone].Y).bRevealed);
+                }
+            }
+            else
+            {
+                TestTrue(What + TEXT(": got through every point or ended the game"), NumDone == Points.Num() || Batched.IsGameOver());
+            }
+            TestEqual(What + TEXT(": bomb hit"), bBatchHitBomb, bSequentialHitBomb);
+            TestSameBoard(*this, What, Sequential, Batched);
+            TestEqual(What + TEXT(": changed tiles"), BatchChanged.Num(), SequentialChanged.Num());
+            TestFalse(What + TEXT(": changed tile only the batch reported"),
+                BatchChanged.ContainsByPredicate([&SequentialChanged](int32 Index) { return !SequentialChanged.Contains(Index); }));
+        }
+    }
+    return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FMinesweeperFlagsChordWinTest, "Minesweeper.Logic.FlagsChordWin",
+    EAutomationTestFlags::EditorContext | EAutomationTestFlags::ProductFilter)
+
+bool FMinesweeperFlagsChordWinTest::RunTest(const FString& Parameters)
+{
+    using namespace MinesweeperTest;
+
+    // * 1 1 *    Opened from the bottom left, which leaves the top row hidden:
+    // 1 1 1 1    the two bombs and the two safe tiles between them
+    // 0 0 0 0
+    // 0 0 0 0
+    constexpr int32 W = 4;
+    const TArray<int32> Bombs = { 0, 3 };
+    auto Start = [this, &Bombs](FMinesweeperGameLogic& Game)
+    {
+        OpenPosition(*this, Game, W, W, Bombs, { 3 * W });
+        TestEqual(TEXT("safe tiles left after the opening"), Game.GetSafeTilesLeft(), 2);
+    };
+    TArray<int32> Changed;
+    bool bHitBomb = false;
+
+    // The flag counter follows toggles, ignores revealed tiles and may run past the bomb count
+    {
+        FMinesweeperGameLogic Game;
+        Start(Game);
+        Game.ToggleFlag(1, 0, Changed);
+        TestTrue(TEXT("flag reported"), Changed == TArray<int32>{ 1 });
+        TestEqual(TEXT("flags after one flag"), Game.GetFlagsPlaced(), 1);
+        TestEqual(TEXT("bombs left after one flag"), Game.GetBombsLeft(), 1);
+
+        Game.ToggleFlag(1, 1, Changed);
+        TestEqual(TEXT("revealed tile flagged"), Changed.Num(), 0);
+        TestEqual(TEXT("flags after flagging a revealed tile"), Game.GetFlagsPlaced(), 1);
+
+        Game.ToggleFlag(0, 0, Changed);
+        Game.ToggleFlag(2, 0, Changed);
+        Game.ToggleFlag(3, 0, Changed);
+        TestEqual(TEXT("flags on every hidden tile"), Game.GetFlagsPlaced(), 4);
+        TestEqual(TEXT("bombs left past zero"), Game.GetBombsLeft(), -2);
+
+        Game.Click(2, 0, bHitBomb, Changed);
+        TestEqual(TEXT("flagged tile clicked"), Changed.Num(), 0);
+
+        Game.ToggleFlag(2, 0, Changed);
+        Game.ToggleFlag(1, 0, Changed);
+        TestEqual(TEXT("flags after unflagging"), Game.GetFlagsPlaced(), 2);
+        TestEqual(TEXT("bombs left with both bombs flagged"), Game.GetBombsLeft(), 0);
+        TestFalse(TEXT("flagging every bomb wins"), Game.IsGameOver());
+    }
+
+    // A chord needs exactly as many flags as its number
+    {
+        FMinesweeperGameLogic Game;
+        Start(Game);
+        Game.Chord(1, 1, bHitBomb, Changed);
+        TestEqual(TEXT("chord without flags"), Changed.Num(), 0);
+
+        Game.ToggleFlag(0, 0, Changed);
+        Game.ToggleFlag(2, 0, Changed);
+        Game.Chord(1, 1, bHitBomb, Changed);
+        TestEqual(TEXT("chord with too many flags"), Changed.Num(), 0);
+        Game.Chord(2, 2, bHitBomb, Changed);
+        TestEqual(TEXT("chord on a zero"), Changed.Num(), 0);
+        Game.Chord(3, 0, bHitBomb, Changed);
+        TestEqual(TEXT("chord on a hidden tile"), Changed.Num(), 0);
+    }
+
+    // A chord whose flags are right opens the rest, and here that wins without the other bomb flagged
+    {
+        FMinesweeperGameLogic Game;
+        Start(Game);
+        Game.ToggleFlag(0, 0, Changed);
+        Game.Chord(1, 1, bHitBomb, Changed);
+        TestFalse(TEXT("right chord hits a bomb"), bHitBomb);
+        Changed.Sort();
+        TestTrue(TEXT("right chord opens"), Changed == TArray<int32>{ 1, 2 });
+        TestTrue(TEXT("right chord wins"), Game.IsWon() && Game.IsGameOver());
+        TestEqual(TEXT("safe tiles left after the win"), Game.GetSafeTilesLeft(), 0);
+        TestEqual(TEXT("flags after the win"), Game.GetFlagsPlaced(), 1);
+
+        Game.ToggleFlag(3, 0, Changed);
+        TestEqual(TEXT("flag after the win"), Changed.Num(), 0);
+    }
+
+    // A chord with a wrong flag opens the bomb the flag should have been on
+    {
+        FMinesweeperGameLogic Game;
+        Start(Game);
+        Game.ToggleFlag(1, 0, Changed);
+        Game.Chord(2, 1, bHitBomb, Changed);
+        TestTrue(TEXT("wrong chord hits a bomb"), bHitBomb);
+        TestTrue(TEXT("wrong chord loses"), Game.IsGameOver() && !Game.IsWon());
+        TestTrue(TEXT("bombs shown"), Game.Get(0, 0).bRevealed && Game.Get(3, 0).bRevealed);
+        TestTrue(TEXT("wrong flag kept"), Game.Get(1, 0).bFlagged != 0);
+    }
+
+    // Clicks win once the last safe tile opens, and nothing moves after
+    {
+        FMinesweeperGameLogic Game;
+        Start(Game);
+        Game.Click(1, 0, bHitBomb, Changed);
+        TestFalse(TEXT("won with a safe tile hidden"), Game.IsGameOver());
+        TestEqual(TEXT("safe tiles left"), Game.GetSafeTilesLeft(), 1);
+        Game.Click(2, 0, bHitBomb, Changed);
+        TestTrue(TEXT("last safe tile wins"), Game.IsWon() && Game.IsGameOver());
+        TestFalse(TEXT("bombs shown on a win"), Game.Get(0, 0).bRevealed != 0);
+
+        Game.Click(0, 0, bHitBomb, Changed);
+        TestTrue(TEXT("click after the win"), Changed.Num() == 0 && !bHitBomb && Game.IsWon());
+    }
+    return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FMinesweeperSolverTest, "Minesweeper.Logic.Solver",
+    EAutomationTestFlags::EditorContext | EAutomationTestFlags::ProductFilter)
+
+bool FMinesweeperSolverTest::RunTest(const FString& Parameters)
+{
+    using namespace MinesweeperTest;
+
+    struct FPosition
+    {
+        const TCHAR* Name;
+        int32 Width;
+        int32 Height;
+        TArray<int32> Bombs;
+        TArray<int32> Open;
+        TArray<int32> Mines;
+        TArray<int32> Safe;
+    };
+    // Square boards, indices Y * Width + X; the rules alone must settle these, the search is switched off
+    const FPosition Positions[] = {
+        // 1 1 .    The corner 1 has a single hidden neighbour, so it is a mine,
+        // ? 1 .    and every other 1 is then satisfied: the right column is safe
+        { TEXT("single tile"), 3, 2, { 3 }, { 0, 1, 4 }, { 3 }, { 2, 5 } },
+
+        // 1 2 1    Against both walls: the 2 needs both ends, so the middle is safe
+        // ? ? ?
+        { TEXT("1-2-1"), 3, 2, { 3, 5 }, { 0, 1, 2 }, { 3, 5 }, { 4 } },
+
+        // 1 1 .    Against the wall: the left 1's pair holds the middle 1's mine, so the right column is safe;
+        // ? ? .    which of the pair is the mine stays open
+        { TEXT("1-1 against a wall"), 3, 2, { 3 }, { 0, 1 }, {}, { 2, 5 } },
+
+        // 1 1 2 1 1    Subset and difference chained along a row: every tile under it is settled
+        // ? ? ? ? ?
+        { TEXT("1-1-2-1-1"), 5, 2, { 6, 8 }, { 0, 1, 2, 3, 4 }, { 6, 8 }, { 5, 7, 9 } },
+    };
+
+    for (const FPosition& Position : Positions)
+    {
+        FMinesweeperGameLogic Game;
+        const TArray<int32> Opened = OpenPosition(*this, Game, Position.Width, Position.Height, Position.Bombs, Position.Open);
+
+        FMinesweeperSolver Solver;
+        Solver.SetMaxEnumerationTiles(0);
+        Solver.Reset(Game);
+        Solver.OnTilesChanged(Opened);
+        Solver.Solve();
+        TestDeductions(*this, Position.Name, Solver, Position.Width * Position.Height, Position.Mines, Position.Safe);
+    }
+
+    // A frontier no single constraint or pair settles, laid out as a graph: A = {a, b} = 1, B = {b, c} = 1 and
+    // C = {a, c, d} = 1. A and B make a == c, so C can only hold its mine in d: a and c are safe, b and d are mines.
+    {
+        enum { a, b, c, d, A, B, C, NumTiles };
+        const TPair<int32, int32> Edges[] = { {A, a}, {A, b}, {B, b}, {B, c}, {C, a}, {C, c}, {C, d} };
+        TArray<int32> Offsets, Neighbours;
+        for (int32 Tile = 0; Tile < NumTiles; ++Tile)
+        {
+            Offsets.Add(Neighbours.Num());
+            for (const TPair<int32, int32>& Edge : Edges)
+            {
+                if (Edge.Key == Tile) Neighbours.Add(Edge.Value);
+                if (Edge.Value == Tile) Neighbours.Add(Edge.Key);
+            }
+        }
+        Offsets.Add(Neighbours.Num());
+        FMinesweeperTopology Graph;
+        if (TestTrue(TEXT("graph made"), FMinesweeperTopology::MakeGraph(NumTiles, 1, Offsets, Neighbours, Graph)))
+        {
+            FMinesweeperGameLogic Game;
+            Game.SetTopology(Graph);
+            const TArray<int32> Opened = OpenPosition(*this, Game, NumTiles, 1, { b, d }, { A, B, C });
+
+            for (const bool bSearch : { false, true })
+            {
+                FMinesweeperSolver Solver;
+                Solver.SetMaxEnumerationTiles(bSearch ? 16 : 0);
+                Solver.Reset(Game);
+                Solver.OnTilesChanged(Opened);
+                Solver.Solve();
+                if (bSearch)
+                {
+                    TestDeductions(*this, TEXT("component search"), Solver, NumTiles, { b, d }, { a, c });
+                }
+                else
+                {
+                    TestDeductions(*this, TEXT("rules alone"), Solver, NumTiles, {}, {});
+                }
+            }
+        }
+    }
+    return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FMinesweeperProbabilityTest, "Minesweeper.Logic.Probability",
+    EAutomationTestFlags::EditorContext | EAutomationTestFlags::ProductFilter)
+
+bool FMinesweeperProbabilityTest::RunTest(const FString& Parameters)
+{
+    using namespace MinesweeperTest;
+
+    constexpr uint8 H = FMinesweeperProbability::Hidden;
+    const std::atomic<bool> bNoCancel { false };
+    auto MakeRow = [](int32 Width)
+    {
+        FMinesweeperTopology Row(EMinesweeperTopology::Square);
+        Row.Build(Width, 1);
+        return Row;
+    };
+
+    // One row: x 1 y 1 z, then five unconstrained tiles. The frontier holds one mine (y) or two (x and z), so its odds
+    // follow the ways to place the rest off it: C(5, Bombs - 1) against C(5, Bombs - 2).
+    {
+        const TArray<uint8> Visible = { H, 1, H, 1, H, H, H, H, H, H };
+        struct FExpected
+        {
+            int32 Bombs;
+            float Y;
+            float XZ;
+            float Unconstrained;
+        };
+        // Bombs 2: weights 5 and 1. Bombs 3: weights 10 and 5.
+        const FExpected Cases[] = { { 2, 5.f / 6.f, 1.f / 6.f, 1.f / 6.f }, { 3, 2.f / 3.f, 1.f / 3.f, 1.f / 3.f } };
+        for (const FExpected& Case : Cases)
+        {
+            const FString What = FString::Printf(TEXT("x1y1z with %d bombs"), Case.Bombs);
+            FMinesweeperProbability Probability;
+            Probability.Reset(MakeRow(Visible.Num()), Case.Bombs);
+            TArray<float> P;
+            if (!TestTrue(What + TEXT(": computed"), Probability.Compute(Visible, P, bNoCancel))) continue;
+            TestEqual(What + TEXT(": revealed"), P[1], -1.f);
+            TestEqual(What + TEXT(": x"), P[0], Case.XZ, 1e-6f);
+            TestEqual(What + TEXT(": y"), P[2], Case.Y, 1e-6f);
+            TestEqual(What + TEXT(": z"), P[4], Case.XZ, 1e-6f);
+            for (int32 i = 5; i < Visible.Num(); ++i)
+            {
+                TestEqual(What + FString::Printf(TEXT(": unconstrained %d"), i), P[i], Case.Unconstrained, 1e-6f);
+            }
+        }
+    }
+
+    // One row: a 1 1 b 1 c, then four unconstrained tiles. Every constraint is forced, so a and b are mines and c is
+    // safe, exactly; the two bombs left spread over the four unconstrained tiles.
+    {
+        const TArray<uint8> Visible = { H, 1, 1, H, 1, H, H, H, H, H };
+        FMinesweeperProbability Probability;
+        Probability.Reset(MakeRow(Visible.Num()), 4);
+        TArray<float> P;
+        if (TestTrue(TEXT("determined frontier computed"), Probability.Compute(Visible, P, bNoCancel)))
+        {
+            TestEqual(TEXT("a is a mine"), P[0], 1.f);
+            TestEqual(TEXT("b is a mine"), P[3], 1.f);
+            TestEqual(TEXT("c is safe"), P[5], 0.f);
+            for (int32 i = 6; i < Visible.Num(); ++i)
+            {
+                TestEqual(FString::Printf(TEXT("unconstrained %d"), i), P[i], 0.5f, 1e-6f);
+            }
+        }
+    }
+
+    // Components reused from the cache, on a board kept up to date tile by tile, give what a fresh computation does
+    for (const EMinesweeperTopology Kind : Topologies)
+    {
+        FMinesweeperGameLogic Game;
+        Game.SetTopology(Kind);
+        Game.NewGame(30, 16, 99, 2468);
+        FRandomStream Rng(int32(Kind));
+        PlaySafeMoves(Game, Rng, 1);
+
+        FMinesweeperProbability Cached;
+        Cached.Reset(Game.GetTopology(), Game.GetNumBombs());
+        TArray<uint8> Visible;
+        FMinesweeperProbability::Snapshot(Game, Visible);
+        Cached.SetVisible(MoveTemp(Visible));
+        TArray<float> CachedP;
+        Cached.Compute(CachedP, bNoCancel);
+
+        int32 Reused = 0;
+        for (int32 Move = 0; Move < 30 && !Game.IsGameOver(); ++Move)
+        {
+            const FString What = FString::Printf(TEXT("topology %d, move %d"), int32(Kind), Move);
+            FMinesweeperGameLogic Before = Game;
+            if (!PlaySafeMove(Game, Rng)) continue;
+
+            // The tiles the move changed, found by comparing, as the widget gets them from the move
+            TArray<int32> Changed;
+            for (int32 Index = 0; Index < Game.GetWidth() * Game.GetHeight(); ++Index)
+            {
+                if (Before.GetByIndex(Index).bRevealed != Game.GetByIndex(Index).bRevealed) Changed.Add(Index);
+            }
+            TArray<uint8> Values;
+            FMinesweeperProbability::Snapshot(Game, Changed, Values);
+            Cached.UpdateVisible(Changed, Values);
+            if (!TestTrue(What + TEXT(": cached computed"), Cached.Compute(CachedP, bNoCancel))) break;
+            Reused += Cached.GetLastCached();
+
+            FMinesweeperProbability Fresh;
+            Fresh.Reset(Game.GetTopology(), Game.GetNumBombs());
+            FMinesweeperProbability::Snapshot(Game, Visible);
+            TArray<float> FreshP;
+            Fresh.Compute(Visible, FreshP, bNoCancel);
+            TestEqual(What + TEXT(": fresh computation reuses nothing"), Fresh.GetLastCached(), 0);
+
+            int32 Mismatches = 0;
+            for (int32 i = 0; i < FreshP.Num(); ++i)
+            {
+                Mismatches += CachedP[i] != FreshP[i];
+            }
+            TestEqual(What + TEXT(": tiles off a fresh computation"), Mismatches, 0);
+        }
+        TestTrue(FString::Printf(TEXT("topology %d: components reused"), int32(Kind)), Reused > 0);
+    }
+    return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FMinesweeperNoGuessTest, "Minesweeper.Generation.NoGuess",
+    EAutomationTestFlags::EditorContext | EAutomationTestFlags::ProductFilter)
+
+bool FMinesweeperNoGuessTest::RunTest(const FString& Parameters)
+{
+    using namespace MinesweeperTest;
+
+    for (const EMinesweeperTopology Kind : Topologies)
+    {
+        const FString What = FString::Printf(TEXT("topology %d"), int32(Kind));
+        const int32 StartX = 3, StartY = 12;
+
+        FMinesweeperGameLogic Game;
+        Game.SetTopology(Kind);
+        const FMinesweeperNoGuessStats Stats = Game.NewGameNoGuess(16, 16, 40, StartX, StartY, 30.0, 2468);
+        if (!TestTrue(What + TEXT(": found a board"), Stats.bSucceeded)) continue;
+        TestTrue(What + TEXT(": bombs placed"), Game.HasPlacedBombs());
+        TestEqual(What + TEXT(": seed"), Game.GetSeed(), Stats.Seed);
+
+        // The kept seed and start tile rebuild the board
+        FMinesweeperGameLogic Rebuilt;
+        Rebuilt.SetTopology(Kind);
+        Rebuilt.NewGame(16, 16, 40, Stats.Seed);
+        Rebuilt.PlaceBombsAround(StartX, StartY);
+        TestSameBoard(*this, What + TEXT(", rebuilt"), Game, Rebuilt);
+
+        // A fresh solver clears the board from the start tile without a guess
+        FMinesweeperSolver Solver;
+        Solver.Reset(Game);
+        TArray<int32> Changed;
+        bool bHitBomb = false;
+        Game.Click(StartX, StartY, bHitBomb, Changed);
+        Solver.OnTilesChanged(Changed);
+        while (!Game.IsGameOver())
+        {
+            Solver.Solve();
+            int32 Next = INDEX_NONE;
+            if (!TestTrue(What + TEXT(": solver finds a safe tile"), Solver.PopSafeTile(Next))) break;
+            Game.Click(Next % Game.GetWidth(), Next / Game.GetWidth(), bHitBomb, Changed);
+            Solver.OnTilesChanged(Changed);
+        }
+        TestTrue(What + TEXT(": solved"), Game.IsWon());
+    }
+    return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FMinesweeperCounterLayoutTest, "Minesweeper.Generation.CounterLayout",
+    EAutomationTestFlags::EditorContext | EAutomationTestFlags::ProductFilter)
+
+bool FMinesweeperCounterLayoutTest::RunTest(const FString& Parameters)
+{
+    struct FCase
+    {
+        EMinesweeperTopology Kind;
+        int32 Width;
+        int32 Height;
+        int32 Bombs;
+        int32 SafeX;
+        int32 SafeY;
+    };
+    // Several generation bands, a safe tile on the wrapping edge, and a board too full to keep the neighbours clear
+    const FCase Cases[] = {
+        { EMinesweeperTopology::Square, 600, 300, 36000, 123, 45 },
+        { EMinesweeperTopology::Torus, 600, 300, 36000, 0, 299 },
+        { EMinesweeperTopology::Hex, 500, 400, 30000, 250, 200 },
+        { EMinesweeperTopology::Square, 4, 4, 14, 1, 1 },
+    };
+    constexpr int32 Seed = 86420;
+
+    for (const FCase& Case : Cases)
+    {
+        const FString What = FString::Printf(TEXT("topology %d, %dx%d"), int32(Case.Kind), Case.Width, Case.Height);
+
+        FMinesweeperGameLogic Game;
+        Game.SetTopology(Case.Kind);
+        Game.SetGenerator(EMinesweeperGenerator::Counter);
+        Game.NewGame(Case.Width, Case.Height, Case.Bombs, Seed);
+        Game.PlaceBombsAround(Case.SafeX, Case.SafeY);
+
+        // Reference: the bombs are the allowed tiles with the smallest keys, found with one serial sort
+        const int32 NumTiles = Case.Width * Case.Height;
+        const int32 SafeIndex = Case.SafeY * Case.Width + Case.SafeX;
+        TArray<bool> Excluded;
+        Excluded.Init(false, NumTiles);
+        Excluded[SafeIndex] = true;
+        int32 NumExcluded = 1;
+        Game.GetTopology().ForEachNeighbour(SafeIndex, [&Excluded, &NumExcluded](int32 N) { Excluded[N] = true; ++NumExcluded; });
+        if (Case.Bombs > NumTiles - NumExcluded)
+        {
+            Excluded.Init(false, NumTiles);
+            Excluded[SafeIndex] = true;
+        }
+        TArray<TPair<uint64, int32>> Keys;
+        for (int32 Index = 0; Index < NumTiles; ++Index)
+        {
+            if (!Excluded[Index]) Keys.Add({ MinesweeperCounterRng::TileKey(Seed, Index), Index });
+        }
+        Keys.Sort([](const TPair<uint64, int32>& A, const TPair<uint64, int32>& B) { return A.Key != B.Key ? A.Key < B.Key : A.Value < B.Value; });
+        TArray<bool> Reference;
+        Reference.Init(false, NumTiles);
+        for (int32 i = 0; i < Case.Bombs; ++i)
+        {
+            Reference[Keys[i].Value] = true;
+        }
+
+        auto FirstMismatch = [&Reference, NumTiles](const FMinesweeperGameLogic& Generated)
+        {
+            for (int32 Index = 0; Index < NumTiles; ++Index)
+            {
+                if (Generated.GetByIndex(Index).bIsBomb != Reference[Index]) return Index;
+            }
+            return int32(INDEX_NONE);
+        };
+        TestEqual(What + TEXT(": first tile off the reference"), FirstMismatch(Game), int32(INDEX_NONE));
+
+        // Boards generated side by side on the workers, each splitting its own bands over whatever threads are left
+        constexpr int32 NumConcurrent = 6;
+        TArray<int32> Mismatches;
+        Mismatches.Init(INDEX_NONE, NumConcurrent);
+        ParallelFor(NumConcurrent, [&](int32 i)
+        {
+            FMinesweeperGameLogic Concurrent;
+            Concurrent.SetUndoEnabled(false);
+            Concurrent.SetTopology(Case.Kind);
+            Concurrent.SetGenerator(EMinesweeperGenerator::Counter);
+            Concurrent.NewGame(Case.Width, Case.Height, Case.Bombs, Seed);
+            Concurrent.PlaceBombsAround(Case.SafeX, Case.SafeY);
+            Mismatches[i] = FirstMismatch(Concurrent);
+        });
+        for (int32 i = 0; i < NumConcurrent; ++i)
+        {
+            TestEqual(What + FString::Printf(TEXT(": concurrent board %d, first tile off the reference"), i), Mismatches[i], int32(INDEX_NONE));
+        }
+    }
+    return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FMinesweeperBandsTest, "Minesweeper.Generation.Bands",
+    EAutomationTestFlags::EditorContext | EAutomationTestFlags::ProductFilter)
+
+bool FMinesweeperBandsTest::RunTest(const FString& Parameters)
+{
+    using namespace MinesweeperTest;
+
+    // Generation and adjacency split the board into bands of whole rows, 64K tiles or one row each. None of these widths
+    // divides that and no height is a whole number of bands, so every band edge falls mid-board and the last band is short.
+    const FIntPoint Sizes[] = { {333, 500}, {1000, 70}, {4097, 40}, {70001, 3} };
+    constexpr int32 Seed = 97531;
+
+    for (const FIntPoint Size : Sizes)
+    {
+        for (const EMinesweeperGenerator Generator : { EMinesweeperGenerator::Stream, EMinesweeperGenerator::Counter })
+        {
+            const FString What = FString::Printf(TEXT("%dx%d, generator %d"), Size.X, Size.Y, int32(Generator));
+            const int32 NumTiles = Size.X * Size.Y;
+            const int32 Bombs = NumTiles / 6;
+            const FIntPoint Safe(Size.X - 1, Size.Y / 2);
+
+            auto Generate = [&](FMinesweeperGameLogic& Board)
+            {
+                Board.SetUndoEnabled(false);
+                Board.SetGenerator(Generator);
+                Board.NewGame(Size.X, Size.Y, Bombs, Seed);
+                Board.PlaceBombsAround(Safe.X, Safe.Y);
+            };
+            FMinesweeperGameLogic Game;
+            Generate(Game);
+
+            // Exactly the bomb count, none around the safe tile
+            int32 Placed = 0;
+            for (int32 Index = 0; Index < NumTiles; ++Index)
+            {
+                Placed += Game.GetByIndex(Index).bIsBomb;
+            }
+            TestEqual(What + TEXT(": bombs placed"), Placed, Bombs);
+            Game.GetTopology().ForEachNeighbour(Game.ToIndex(Safe.X, Safe.Y), [&](int32 N)
+            {
+                TestFalse(What + TEXT(": bomb next to the safe tile"), Game.GetByIndex(N).bIsBomb != 0);
+            });
+
+            // Counts across band edges match a plain count
+            int32 Mismatches = 0;
+            for (int32 y = 0; y < Size.Y; ++y)
+            {
+                for (int32 x = 0; x < Size.X; ++x)
+                {
+                    if (Game.Get(x, y).bIsBomb) continue;
+                    int32 Count = 0;
+                    for (int32 ny = FMath::Max(0, y - 1); ny <= FMath::Min(Size.Y - 1, y + 1); ++ny)
+                    {
+                        for (int32 nx = FMath::Max(0, x - 1); nx <= FMath::Min(Size.X - 1, x + 1); ++nx)
+                        {
+                            Count += (nx != x || ny != y) && Game.Get(nx, ny).bIsBomb;
+                        }
+                    }
+                    Mismatches += Count != Game.Get(x, y).Adjacent;
+                }
+            }
+            TestEqual(What + TEXT(": counts off a plain count"), Mismatches, 0);
+
+            // The counter layout has a serial reference: the allowed tiles with the smallest keys
+            if (Generator == EMinesweeperGenerator::Counter)
+            {
+                TArray<bool> Excluded;
+                Excluded.Init(false, NumTiles);
+                Excluded[Game.ToIndex(Safe.X, Safe.Y)] = true;
+                Game.GetTopology().ForEachNeighbour(Game.ToIndex(Safe.X, Safe.Y), [&Excluded](int32 N) { Excluded[N] = true; });
+                TArray<TPair<uint64, int32>> Keys;
+                for (int32 Index = 0; Index < NumTiles; ++Index)
+                {
+                    if (!Excluded[Index]) Keys.Add({ MinesweeperCounterRng::TileKey(Seed, Index), Index });
+                }
+                Keys.Sort([](const TPair<uint64, int32>& A, const TPair<uint64, int32>& B) { return A.Key != B.Key ? A.Key < B.Key : A.Value < B.Value; });
+                int32 OffReference = 0;
+                for (int32 i = 0; i < Keys.Num(); ++i)
+                {
+                    OffReference += (i < Bombs) != (Game.GetByIndex(Keys[i].Value).bIsBomb != 0);
+                }
+                TestEqual(What + TEXT(": tiles off the serial reference"), OffReference, 0);
+            }
+
+            // However the bands get scheduled, the board comes out the same
+            constexpr int32 NumConcurrent = 4;
+            TArray<FMinesweeperGameLogic> Concurrent;
+            Concurrent.SetNum(NumConcurrent);
+            ParallelFor(NumConcurrent, [&](int32 i) { Generate(Concurrent[i]); });
+            for (int32 i = 0; i < NumConcurrent; ++i)
+            {
+                TestSameBoard(*this, What + FString::Printf(TEXT(", concurrent board %d"), i), Game, Concurrent[i]);
+            }
+        }
+    }
+    return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FMinesweeperGenerationCancelTest, "Minesweeper.Generation.Cancel",
+    EAutomationTestFlags::EditorContext | EAutomationTestFlags::ProductFilter)
+
+bool FMinesweeperGenerationCancelTest::RunTest(const FString& Parameters)
+{
+    // Cancelled before it starts: no candidate is tried and the deferred plain board is kept
+    {
+        FMinesweeperGenerationControl Control;
+        Control.bCancel = true;
+        FMinesweeperGameLogic Game;
+        const FMinesweeperNoGuessStats Stats = Game.NewGameNoGuess(30, 16, 99, 15, 8, 60.0, 1357, &Control);
+        TestFalse(TEXT("cancelled up front: succeeded"), Stats.bSucceeded);
+        TestEqual(TEXT("cancelled up front: attempts"), Stats.Attempts, 0);
+        TestFalse(TEXT("cancelled up front: bombs placed"), Game.HasPlacedBombs());
+        TestEqual(TEXT("cancelled up front: bombs"), Game.GetNumBombs(), 99);
+    }
+
+    // Cancelled while running, from another thread, once the first candidate is reported rather than after a fixed delay.
+    // Whether a candidate passes before the cancel lands is up to the scheduler, so only what holds either way is checked:
+    // many quick hopeless candidates, and huge ones where the cancel can land inside the solver
+    struct FCase
+    {
+        int32 Width;
+        int32 Height;
+        int32 Bombs;
+    };
+    const FCase Cases[] = { { 30, 16, 200 }, { 1000, 1000, 150000 } };
+    const double MaxSeconds = 60.0;
+    for (const FCase& Case : Cases)
+    {
+        const FString What = FString::Printf(TEXT("cancelled while running, %dx%d"), Case.Width, Case.Height);
+
+        FMinesweeperGenerationControl Control;
+        std::atomic<bool> bFinished { false };
+        TFuture<void> Canceller = Async(EAsyncExecution::Thread, [&Control, &bFinished]()
+        {
+            while (Control.Attempts.load() == 0 && !bFinished)
+            {
+                FPlatformProcess::Yield();
+            }
+            Control.bCancel = true;
+        });
+
+        FMinesweeperGameLogic Game;
+        const FMinesweeperNoGuessStats Stats = Game.NewGameNoGuess(Case.Width, Case.Height, Case.Bombs, Case.Width / 2, Case.Height / 2, MaxSeconds, 1357,
+            &Control);
+        bFinished = true;
+        Canceller.Wait();
+
+        TestTrue(What + TEXT(": tried candidates"), Stats.Attempts > 0);
+        TestEqual(What + TEXT(": reported attempts"), Control.Attempts.load(), Stats.Attempts);
+        TestTrue(What + TEXT(": ended by the cancel or a pass, not the time budget"), Stats.bSucceeded || Stats.Seconds < MaxSeconds);
+        TestEqual(What + TEXT(": bombs placed only for a passing board"), Game.HasPlacedBombs(), Stats.bSucceeded);
+    }
+    return true;
+}
+
+#endif
@@ -0,0 +1,51 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+// Bomb layout stored as packed bit rows: one uint64 word covers 64 tiles of a row.
+// Adjacency counts come out a row at a time as four bit planes (bit 0..3 of the count) computed with row-wide bitwise adds.
+class FMinesweeperBitBoard
+{
+public:
+	// Resizes the board and clears it
+	void Init(int32 InW, int32 InH);
+
+	// Counts the bomb neighbours of every tile of row Y, 64 tiles per word operation. OutPlanes takes 4 * GetWordsPerRow()
+	// words: plane P (bit P of the count) starts at OutPlanes + P * GetWordsPerRow(). Reads only the bomb plane, so rows
+	// may be counted concurrently.
+	void CountAdjacencyRow(int32 Y, uint64* OutPlanes) const;
+
+	// Counts bomb neighbours for the 64 tiles of Mid[1] into four count planes.
+	// Each row is passed as {word to the left, word, word to the right}.
+	static void CountNeighbours(const uint64 Up[3], const uint64 Mid[3], const uint64 Down[3], uint64 OutPlanes[4]);
+
+	// Saves or loads the bomb plane as raw words; when loading, Init must already have set the size
+	void SerializeBombs(FArchive& Ar);
+
+	bool IsBomb(int32 X, int32 Y) const { return (Bombs[Y * WordsPerRow + (X >> 6)] >> (X & 63)) & 1; }
+
+	void SetBomb(int32 X, int32 Y, bool bValue)
+	{
+		uint64& Word = Bombs[Y * WordsPerRow + (X >> 6)];
+		const uint64 Mask = uint64(1) << (X & 63);
+		Word = bValue ? (Word | Mask) : (Word & ~Mask);
+	}
+
+	// Raw row access: word W of row Y covers tiles [W * 64, W * 64 + 63]
+	const uint64* GetBombRow(int32 Y) const { return Bombs.GetData() + Y * WordsPerRow; }
+
+	int32 GetWidth() const { return Width; }
+	int32 GetHeight() const { return Height; }
+	int32 GetWordsPerRow() const { return WordsPerRow; }
+
+private:
+	TArray<uint64> Bombs;
+
+	// Stands in for the missing rows above the top edge and below the bottom edge
+	TArray<uint64> ZeroRow;
+	int32 Width = 0;
+	int32 Height = 0;
+	int32 WordsPerRow = 0;
+};
@@ -0,0 +1,124 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "MinesweeperTile.h"
+
+// Endless board split into fixed-size chunks that are created the first time a click or flood fill touches them.
+// A chunk's bombs are a pure function of (seed, chunk coordinate, first click), so untouched chunks need no storage at all.
+// The view pages chunks in and out with PageTo: a chunk that leaves it keeps only its revealed and flagged bits, and a
+// chunk the player never changed keeps nothing.
+class FMinesweeperChunkedBoard
+{
+public:
+	static constexpr int32 ChunkShift = 6;
+	static constexpr int32 ChunkSize = 1 << ChunkShift;
+
+	// Tiles stay inside (-MaxCoord, MaxCoord) on both axes, so neighbour arithmetic never overflows
+	static constexpr int32 MaxCoord = 1 << 30;
+
+	// Starts a new endless game with the given bombs per chunk and optional random seed
+	void NewGame(int32 InBombsPerChunk, int32 RandomSeed = 0);
+
+	static bool IsValid(int32 X, int32 Y) { return X > -MaxCoord && X < MaxCoord && Y > -MaxCoord && Y < MaxCoord; }
+
+	// Returns whether the game is over; an endless game only ends on a bomb
+	bool IsGameOver() const { return bGameOver; }
+
+	// Processes a click at any world coordinate; out flag for a bomb hit and the coordinates of every tile that changed.
+	// The first click keeps its tile and neighbours clear. Flagged tiles ignore clicks; cascades open through wrong flags and clear them.
+	void Click(int32 X, int32 Y, bool& bOutHitBomb, TArray<FIntPoint>& OutChanged);
+
+	// Flags or unflags a hidden tile; OutChanged holds the tile if it changed
+	void ToggleFlag(int32 X, int32 Y, TArray<FIntPoint>& OutChanged);
+
+	// On a revealed number with exactly that many flagged neighbours, opens every other hidden neighbour.
+	// Reports like Click; a wrong flag makes this hit a bomb.
+	void Chord(int32 X, int32 Y, bool& bOutHitBomb, TArray<FIntPoint>& OutChanged);
+
+	// Tile view at a world coordinate. Only resident chunks are read and other tiles read as hidden, so PageTo the view first.
+	// Once the game is lost, bombs read as revealed.
+	FMSPTile Get(int32 X, int32 Y) const;
+
+	// Makes the chunks over tiles [Tiles.Min, Tiles.Max) resident and pages out those more than a chunk away from them.
+	// Only chunks the player changed are paged in while the game goes on; once it is lost every chunk in view is, to show
+	// its bombs. Returns whether a chunk was paged in, i.e. whether Get now reads differently somewhere in Tiles.
+	bool PageTo(const FIntRect& Tiles);
+
+	// Caps how many tiles one cascade may reveal; zero runs past the cap stay hidden for a later click
+	void SetMaxCascadeTiles(int32 InMaxTiles) { MaxCascadeTiles = FMath::Max(1, InMaxTiles); }
+
+	// Chunks held in full, and chunks paged out with only the player's marks kept
+	int32 GetNumChunks() const { return Chunks.Num(); }
+	int32 GetNumPagedOutChunks() const { return PagedOut.Num(); }
+
+	int32 GetBombsPerChunk() const { return BombsPerChunk; }
+	int32 GetSeed() const { return Seed; }
+	int32 GetTilesRevealed() const { return TilesRevealed; }
+	int32 GetFlagsPlaced() const { return FlagsPlaced; }
+
+private:
+	// What the player did to a chunk; all that is kept of it while it is paged out
+	struct FChunkMarks
+	{
+		uint64 Revealed[ChunkSize];
+		uint64 Flagged[ChunkSize];
+
+		bool IsEmpty() const;
+	};
+
+	struct FChunk
+	{
+		uint64 Bombs[ChunkSize];
+		uint64 Adjacency[4][ChunkSize];
+		FChunkMarks Marks;
+	};
+
+	static FIntPoint ToChunkCoord(int32 X, int32 Y) { return FIntPoint(X >> ChunkShift, Y >> ChunkShift); }
+
+	// Deterministically derives a chunk's bomb rows from the seed and its coordinate, clear around the first click
+	void GenerateBombs(FIntPoint ChunkCoord, uint64 OutRows[ChunkSize]) const;
+
+	// Fills a chunk's bombs and adjacency; the neighbours' bombs are regenerated to count across chunk edges
+	void GenerateChunk(FIntPoint ChunkCoord, FChunk& OutChunk) const;
+
+	// Finds the chunk or creates it, taking back its marks if it was paged out
+	FChunk& TouchChunk(FIntPoint ChunkCoord);
+
+	// Chunk holding a world tile, plus the tile's local coordinates inside it
+	FChunk& TouchTile(int32 X, int32 Y, int32& OutLocalX, int32& OutLocalY);
+
+	bool IsBomb(int32 X, int32 Y);
+	bool IsRevealed(int32 X, int32 Y);
+	bool IsFlagged(int32 X, int32 Y);
+	int32 GetAdjacent(int32 X, int32 Y);
+
+	// Opens one hidden tile: a bomb only sets bOutHitBomb, a zero starts a cascade
+	void OpenTile(int32 X, int32 Y, bool& bOutHitBomb, TArray<FIntPoint>& OutChanged);
+
+	// Marks a tile revealed, clearing a wrong flag; false if it already was
+	bool Reveal(int32 X, int32 Y, TArray<FIntPoint>& OutChanged);
+
+	// Scanline fill of the zero region around a zero tile, bounded by MaxCascadeTiles
+	void FloodFillZeros(int32 StartX, int32 StartY, TArray<FIntPoint>& OutChanged);
+
+private:
+	TMap<FIntPoint, TUniquePtr<FChunk>> Chunks;
+	TMap<FIntPoint, TUniquePtr<FChunkMarks>> PagedOut;
+
+	// Last chunk looked up, so runs inside one chunk skip the map
+	FIntPoint CachedCoord = FIntPoint(MAX_int32, MAX_int32);
+	FChunk* CachedChunk = nullptr;
+
+	TArray<FIntPoint> FloodStack;
+	// First click, kept clear of bombs along with its neighbours
+	FIntPoint SafeTile = FIntPoint::ZeroValue;
+	int32 BombsPerChunk = 0;
+	int32 Seed = 0;
+	int32 MaxCascadeTiles = 1 << 20;
+	int32 TilesRevealed = 0;
+	int32 FlagsPlaced = 0;
+	bool bStarted = false;
+	bool bGameOver = false;
+};
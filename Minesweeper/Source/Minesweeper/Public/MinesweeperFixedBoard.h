@@ -0,0 +1,67 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "MinesweeperTile.h"
+
+// Kernels for a board whose size is known at compile time, run on FMinesweeperGameLogic's padded grid:
+// (W + 2) x (H + 2) tiles whose one-tile border is marked revealed, so neighbour loops need no bounds checks.
+// Strides and neighbour offsets are constants, so the compiler can unroll every neighbour loop.
+template <int32 W, int32 H>
+struct TMinesweeperBoard
+{
+	static constexpr int32 Stride = W + 2;
+	static constexpr int32 NumPaddedTiles = Stride * (H + 2);
+	static constexpr int32 NeighbourOffsets[8] = { -Stride - 1, -Stride, -Stride + 1, -1, 1, Stride - 1, Stride, Stride + 1 };
+
+	static constexpr int32 ToPadded(int32 X, int32 Y) { return (Y + 1) * Stride + X + 1; }
+	static constexpr int32 ToBoardIndex(int32 Padded) { return (Padded / Stride - 1) * W + Padded % Stride - 1; }
+
+	// Marks the bombs and counts them into their neighbours on a freshly cleared grid.
+	// Edge bombs count into the border, which is never read as a number.
+	static void CountAdjacency(FMSPTile* Grid, TArrayView<const int32> BombIndices)
+	{
+		for (const int32 Index : BombIndices)
+		{
+			const int32 P = ToPadded(Index % W, Index / W);
+			Grid[P].bIsBomb = true;
+			for (int32 n = 0; n < 8; ++n)
+			{
+				++Grid[P + NeighbourOffsets[n]].Adjacent;
+			}
+		}
+
+		// Bomb tiles carry no count
+		for (const int32 Index : BombIndices)
+		{
+			Grid[ToPadded(Index % W, Index / W)].Adjacent = 0;
+		}
+	}
+
+	// Reveals the zero region around the zero tile at (StartX, StartY) plus its numbered border,
+	// recording board indices (Y * W + X) in OutChanged. Neighbours of a zero tile are never bombs.
+	static void FloodFill(FMSPTile* Grid, int32 StartX, int32 StartY, TArray<int32>& Stack, TArray<int32>& OutChanged)
+	{
+		const int32 Start = ToPadded(StartX, StartY);
+		Grid[Start].bRevealed = true;
+		OutChanged.Add(ToBoardIndex(Start));
+
+		Stack.Reset();
+		Stack.Add(Start);
+		while (Stack.Num() > 0)
+		{
+			const int32 P = Stack.Pop(EAllowShrinking::No);
+			for (int32 n = 0; n < 8; ++n)
+			{
+				const int32 Q = P + NeighbourOffsets[n];
+				FMSPTile& T = Grid[Q];
+				if (T.bRevealed) continue;
+
+				T.bRevealed = true;
+				OutChanged.Add(ToBoardIndex(Q));
+				if (T.Adjacent == 0) Stack.Add(Q);
+			}
+		}
+	}
+};
@@ -3,53 +3,266 @@
 #pragma once
 
 #include "CoreMinimal.h"
+#include "MinesweeperTile.h"
+#include "MinesweeperBitBoard.h"
+#include "MinesweeperTopology.h"
+#include <atomic>
 
-struct FMSPTile
+// Outcome of a no-guess generation run
+struct FMinesweeperNoGuessStats
 {
-	bool bIsBomb = false;
-	bool bRevealed = false;
-	int32 Adjacent = 0;
+	// Candidate layouts generated, across all workers
+	int32 Attempts = 0;
+	// Wall time spent generating
+	double Seconds = 0.0;
+	// Seed of the board that was kept
+	int32 Seed = 0;
+	// False if the time budget ran out and a plain board was kept instead
+	bool bSucceeded = false;
+};
+
+// Lets another thread follow and stop a generation running in the background
+struct FMinesweeperGenerationControl
+{
+	// Set to stop early; generation then ends as if its time budget ran out
+	std::atomic<bool> bCancel { false };
+	// Candidate layouts tried so far
+	std::atomic<int32> Attempts { 0 };
+};
+
+// How the bombs are drawn from a game's seed; one seed gives a different board under each
+enum class EMinesweeperGenerator : uint8
+{
+	// Row bands sampled with sequential streams split off the seed
+	Stream,
+	// Every tile gets a counter-based random key from (seed, tile index) and the bombs are the tiles with the smallest keys.
+	// No stream state is carried from tile to tile, so any region can be keyed on its own, in any order, on any thread.
+	Counter
 };
 
 class FMinesweeperGameLogic
 {
 public:
-	// Starts a new game with given width, height, bomb count, and optional random seed
+	// Largest board side the UI offers; replays of bigger boards are treated as corrupt
+	static constexpr int32 MaxSide = 2000;
+
+	// Starts a new game with given width, height, bomb count, and optional random seed.
+	// Bombs are not placed until the first click, which always lands on an opening.
 	void NewGame(int32 InW, int32 InH, int32 InBombs, int32 RandomSeed = 0);
+
+	// Places the bombs now, keeping (SafeX, SafeY) and its neighbours clear; does nothing once they are placed.
+	// The layout depends only on the seed and this tile.
+	void PlaceBombsAround(int32 SafeX, int32 SafeY);
+
+	// Starts a new game on a given layout, bombs at the listed indices (Y * Width + X), e.g. a puzzle or a test position.
+	// Fails on an index off the board, a repeated one, or a layout with no safe tile, leaving a game with no bombs placed.
+	bool NewGameWithBombs(int32 InW, int32 InH, TArrayView<const int32> InBombIndices);
+
+	// Topology for the games that follow, Square by default. Applies from the next NewGame, which sizes it
+	// (building the hex neighbour table), so call it right before one. Graphs need their table, so only the overload taking
+	// a topology accepts one; a graph also fixes the board size NewGame uses.
+	void SetTopology(EMinesweeperTopology Kind) { if (Kind != EMinesweeperTopology::Graph) Topology = FMinesweeperTopology(Kind); }
+	void SetTopology(const FMinesweeperTopology& InTopology) { Topology = InTopology; }
+
+	// Neighbours of the current board, shared by the game, solver and renderer
+	const FMinesweeperTopology& GetTopology() const { return Topology; }
+
+	// Generator for the bombs of the games that follow, Stream by default; saved with the game and kept across NewGame
+	void SetGenerator(EMinesweeperGenerator InGenerator) { Generator = InGenerator; }
+	EMinesweeperGenerator GetGenerator() const { return Generator; }
+
+	// False until the first click (or PlaceBombsAround) has placed the bombs
+	bool HasPlacedBombs() const { return bBombsPlaced; }
+
+	// Starts a new game that the solver can clear from a click on (StartX, StartY) without guessing.
+	// Candidate layouts are checked in parallel and the first success cancels the rest;
+	// after MaxSeconds a plain board with the usual first-click placement is kept instead.
+	// Control, if given, reports progress and can cut the search short from another thread.
+	FMinesweeperNoGuessStats NewGameNoGuess(int32 InW, int32 InH, int32 InBombs, int32 StartX, int32 StartY, double MaxSeconds = 5.0, int32 RandomSeed = 0,
+		FMinesweeperGenerationControl* Control = nullptr);
 	
 	bool IsValid(int32 X, int32 Y) const;
 
 	// Returns whether the game is over
 	bool IsGameOver() const { return bGameOver; }
 
-	// Returns: true if click was processed; out flags for what happened.
-	void Click(int32 X, int32 Y, bool& bOutHitBomb, bool& bOutChanged);
+	// Game over with every safe tile revealed
+	bool IsWon() const { return bWon; }
+
+	// Processes a click; out flag for a bomb hit and the indices (Y * Width + X) of every tile that changed.
+	// Flagged tiles ignore clicks. Cascades open through wrong flags and clear them.
+	void Click(int32 X, int32 Y, bool& bOutHitBomb, TArray<int32>& OutChanged);
+
+	// Clicks every point in order as one move: one merged change set, one undo step, one pass over the counters.
+	// Points Click would ignore are skipped; the batch stops at the first bomb or once the game is won. With
+	// bStopAtRevealed it also stops before a point whose tile is already open, e.g. by an earlier point's cascade, for
+	// callers that treat such a click differently. Returns how many points it got through.
+	int32 ClickMany(TArrayView<const FIntPoint> Points, bool& bOutHitBomb, TArray<int32>& OutChanged, bool bStopAtRevealed = false);
+
+	// Flags or unflags a hidden tile; OutChanged holds the tile if it changed
+	void ToggleFlag(int32 X, int32 Y, TArray<int32>& OutChanged);
+
+	// On a revealed number with exactly that many flagged neighbours (in the board's topology), opens every other hidden neighbour.
+	// Reports like Click; a wrong flag makes this hit a bomb.
+	void Chord(int32 X, int32 Y, bool& bOutHitBomb, TArray<int32>& OutChanged);
 	
 	// Accessors
-	const FMSPTile& Get(int32 X, int32 Y) const { return Grid[Y * Width + X]; }
+	const FMSPTile& Get(int32 X, int32 Y) const { return Grid[GridIndex(X, Y)]; }
+	const FMSPTile& GetByIndex(int32 Index) const { return Get(Index % Width, Index / Width); }
+	int32 ToIndex(int32 X, int32 Y) const { return Y * Width + X; }
 	int32 GetWidth() const { return Width; }
 	int32 GetHeight() const { return Height; }
+	int32 GetNumBombs() const { return NumBombs; }
+	bool IsFlagged(int32 X, int32 Y) const { return Grid[GridIndex(X, Y)].bFlagged; }
+
+	// Move counters, kept up to date by every move
+	int32 GetSafeTilesLeft() const { return SafeTilesLeft; }
+	int32 GetFlagsPlaced() const { return FlagsPlaced; }
+	int32 GetBombsLeft() const { return NumBombs - FlagsPlaced; }
+
+	// Seed the current board was generated from; NewGame with it rebuilds the same board
+	int32 GetSeed() const { return Seed; }
+
+	// Saves or loads the game as packed bit planes: 1 bit per tile for bombs and flags, and revealed either
+	// as a bitmap or run-length encoded, whichever is smaller, plus the topology. Adjacency is recomputed on load.
+	// A failed load leaves the archive in error.
+	void Serialize(FArchive& Ar);
+
+	// Steps back over the last move, including one that lost the game; OutChanged holds the tiles it restored.
+	// Bomb placement is never undone. Returns false when there is nothing to undo.
+	bool Undo(TArray<int32>& OutChanged);
+
+	// Re-applies the last undone move from the journal; a new move drops everything left to redo
+	bool Redo(TArray<int32>& OutChanged);
+
+	bool CanUndo() const { return JournalCursor > 0; }
+	bool CanRedo() const { return JournalCursor < Journal.Num(); }
+
+	// Journaling costs a little per move; headless players that never undo turn it off. On by default.
+	void SetUndoEnabled(bool bEnabled);
 
 private:
+	// One undo journal entry and the revealed-index runs it points into
+	struct FRevealRun
+	{
+		int32 Start = 0;
+		int32 Num = 0;
+	};
+	struct FJournalEntry
+	{
+		int32 FirstRun = 0;
+		int32 NumRuns = 0;
+		int32 FirstFlag = 0;
+		int32 NumFlags = 0;
+		// Safe tiles the move revealed (bombs shown on a loss are in the runs but not here)
+		int32 SafeRevealed = 0;
+		bool bEndedGame = false;
+		bool bWon = false;
+	};
+
+	// Position of tile (X, Y) in the padded Grid
+	int32 GridIndex(int32 X, int32 Y) const { return (Y + 1) * (Width + 2) + X + 1; }
+
+	// Tile for a board index (Y * Width + X)
+	FMSPTile& TileAt(int32 Index) { return Grid[GridIndex(Index % Width, Index / Width)]; }
+
+	// Sizes the padded grid for Width x Height, marks the border and picks the kernels for the size
+	void InitGrid();
+
+	// Tiles kept clear of bombs for a first click on (SafeX, SafeY), in ascending index order
+	using FExcludedTiles = TArray<int32, TInlineAllocator<FMinesweeperTopology::MaxDegree + 1>>;
+	void GetExcludedTiles(int32 Bombs, int32 SafeX, int32 SafeY, FExcludedTiles& OutExcluded) const;
 
-	// Place bombs randomly on the grid
-	void PlaceBombs(int32 Bombs, FRandomStream& Rng);
+	// Place bombs randomly on the grid, away from the given safe tile
+	void PlaceBombs(int32 Bombs, int32 SafeX, int32 SafeY, FRandomStream& Rng);
+
+	// PlaceBombs for the Counter generator, keyed from Seed
+	void PlaceBombsCounter(int32 Bombs, int32 SafeX, int32 SafeY);
 
 	// Computes the number of adjacent bombs for each tile
 	void ComputeAdjacency();
 
-	// Counts bombs around a specific tile
-	int32 CountAdj(int32 X, int32 Y) const;
+	// ComputeAdjacency and FloodFillZeros for non-square topologies, walking FMinesweeperTopology::ForEachNeighbour
+	void ComputeAdjacencyByNeighbour();
+	void FloodFillByNeighbour(int32 Start, TArray<int32>& OutChanged);
+
+	// Copies one row of bombs, and its counts from the four planes CountAdjacencyRow filled, into the grid
+	void UnpackRow(int32 Y, const uint64* AdjPlanes);
+
+	// Rows per parallel generation band
+	int32 GetBandRows() const;
+
+	// Revealed plane for Serialize; returns the encoding used
+	uint8 EncodeRevealed(TArray<uint8>& Out) const;
+	bool DecodeRevealed(TArrayView<const uint8> Data, uint8 Encoding);
+
+	// Rebuilds BombIndices from the bomb plane
+	void CollectBombIndices();
 
-	// Reveal a tile
-	void Reveal(int32 X, int32 Y);
+	// Opens one hidden, unflagged tile; a bomb only sets bOutHitBomb, the caller ends the game
+	void OpenTile(int32 X, int32 Y, bool& bOutHitBomb, TArray<int32>& OutChanged);
 
-	// Recursively reveals zero-adjacent tiles
-	void FloodFillZeros(int32 StartX, int32 StartY);
+	// Updates the counters for the tiles a move revealed, then ends the game on a bomb hit or the last safe tile
+	void EndMove(bool bHitBomb, TArray<int32>& OutChanged);
+
+	// Drops anything left to redo and starts a journal entry for a new move
+	FJournalEntry& AddJournalEntry();
+
+	// Records revealed indices on an entry, merging consecutive ones into runs
+	void JournalReveals(FJournalEntry& Entry, TArrayView<const int32> Indices);
+
+	// Clears the journal; done whenever the board is replaced
+	void ResetJournal();
+
+	// Reveal a tile, recording its index in OutChanged
+	void Reveal(int32 X, int32 Y, TArray<int32>& OutChanged);
+
+	// Reveals the zero-adjacent region around a zero tile run by run, recording each revealed index in OutChanged
+	void FloodFillZeros(int32 StartX, int32 StartY, TArray<int32>& OutChanged);
 
 private:
+	// Tiles per generation band; fixed so generation never depends on the number of worker threads
+	static constexpr int32 GenerationBandTiles = 1 << 16;
+
+	// Bumped whenever the Serialize layout changes
+	static constexpr int32 SaveVersion = 5;
+
+	// (Width + 2) x (Height + 2) tiles; the one-tile border reads as revealed so fills stop there without bounds checks
 	TArray<FMSPTile> Grid;
+	// Bomb layout as packed bits: where generation places bombs, what large square boards count adjacency from, and
+	// the saved form of the bombs. The tiles hold everything else.
+	FMinesweeperBitBoard Bits;
+	FMinesweeperTopology Topology;
+	EMinesweeperGenerator Generator = EMinesweeperGenerator::Stream;
+
+	// TMinesweeperBoard kernels when a square board matches a preset (9x9, 16x16, 30x16), otherwise null
+	void (*FixedCountAdjacency)(FMSPTile*, TArrayView<const int32>) = nullptr;
+	void (*FixedFloodFill)(FMSPTile*, int32, int32, TArray<int32>&, TArray<int32>&) = nullptr;
+	// Fill stack for the fixed-size and neighbour-walking fills
+	TArray<int32> FixedStack;
+
+	// Index of every bomb, so the loss reveal touches bombs only
+	TArray<int32> BombIndices;
+
+	// Undo journal: per move, slices of the shared run and flag pools plus how the move changed the counters.
+	// Memory grows with the tiles moves changed, never with the board size.
+	TArray<FJournalEntry> Journal;
+	TArray<FRevealRun> RevealRuns;
+	// Tiles whose flag the move toggled
+	TArray<int32> FlagToggles;
+	// Entries [0, JournalCursor) are applied, the rest can be redone
+	int32 JournalCursor = 0;
+	bool bUndoEnabled = true;
+
+	// Pending run seeds for FloodFillZeros; kept between calls so a fill allocates nothing once warmed up
+	TArray<FIntPoint> FloodStack;
 	int32 Width = 0;
 	int32 Height = 0;
+	int32 NumBombs = 0;
+	int32 Seed = 0;
+	int32 SafeTilesLeft = 0;
+	int32 FlagsPlaced = 0;
 	bool bGameOver = false;
+	bool bWon = false;
+	bool bBombsPlaced = false;
 };
\ No newline at end of file
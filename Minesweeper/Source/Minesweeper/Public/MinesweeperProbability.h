@@ -0,0 +1,82 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "MinesweeperTopology.h"
+#include <atomic>
+
+class FMinesweeperGameLogic;
+
+// Mine probability of every hidden tile, worked out from what the player can see.
+// The frontier (hidden tiles next to a revealed number) is split into independent components. Each component's
+// consistent mine layouts are enumerated and counted per mine total, then the components are combined, weighting
+// each total by the ways to place the remaining bombs on the unconstrained tiles.
+// Component counts are cached by the component's exact shape, so a move only re-enumerates the components it changed.
+// Not thread safe: meant to be driven by one task at a time, off the game thread.
+class FMinesweeperProbability
+{
+public:
+	// Visible value of a tile that is not revealed
+	static constexpr uint8 Hidden = 0xFF;
+
+	// Copies what the player sees of Game, one byte per tile (Y * Width + X): a revealed tile's number, or Hidden.
+	// Flags are the player's guesses, so flagged tiles read as hidden.
+	static void Snapshot(const FMinesweeperGameLogic& Game, TArray<uint8>& OutVisible);
+
+	// Same, for the listed tile indices only: OutValues[i] is what Snapshot gives Tiles[i]
+	static void Snapshot(const FMinesweeperGameLogic& Game, TArrayView<const int32> Tiles, TArray<uint8>& OutValues);
+
+	// Binds to a board's topology and bomb count, clears the cache and starts the kept board all hidden
+	void Reset(const FMinesweeperTopology& InTopology, int32 InBombs);
+
+	// Replaces the kept board, the one the Compute overload without a board reads, with a full Snapshot
+	void SetVisible(TArray<uint8>&& InVisible);
+
+	// Brings single tiles of the kept board up to date from a Snapshot of just those tiles
+	void UpdateVisible(TArrayView<const int32> Tiles, TArrayView<const uint8> Values);
+
+	// Fills OutProbability with the chance each tile is a mine; revealed tiles get -1, as do the tiles of a component
+	// too large to enumerate (those are counted with the unconstrained tiles instead).
+	// Returns false, leaving OutProbability incomplete, if bCancel was raised first.
+	bool Compute(TArrayView<const uint8> Visible, TArray<float>& OutProbability, const std::atomic<bool>& bCancel);
+
+	// Compute over the kept board
+	bool Compute(TArray<float>& OutProbability, const std::atomic<bool>& bCancel) { return Compute(KeptVisible, OutProbability, bCancel); }
+
+	// Components enumerated, and reused from the cache, by the last Compute
+	int32 GetLastEnumerated() const { return LastEnumerated; }
+	int32 GetLastCached() const { return LastCached; }
+
+	// Components with more tiles than this are not enumerated
+	static constexpr int32 MaxComponentTiles = 64;
+
+private:
+	// Consistent layouts of one component per mine total m: Ways[m] of them, TileWays[m * Tiles.Num() + t] with tile t a mine.
+	// Both are scaled so Ways sums to 1; the scale cancels out when components are combined.
+	struct FComponent
+	{
+		TArray<int32> Tiles;
+		TArray<double> Ways;
+		TArray<double> TileWays;
+		bool bExact = true;
+	};
+
+	// Counts the layouts of C.Tiles (ordered so constraints close early) against the component's constraints,
+	// given as local tile indices and the mines each still needs
+	void Enumerate(FComponent& C, const TArray<TArray<int32, TInlineAllocator<8>>>& ConstraintTiles, const TArray<int32>& ConstraintMines,
+		const std::atomic<bool>& bCancel) const;
+
+private:
+	FMinesweeperTopology Topology;
+	int32 Bombs = 0;
+
+	// What the player sees, kept between passes so a caller only has to send the tiles a move changed
+	TArray<uint8> KeptVisible;
+
+	// Keyed by a hash of the component's constraints and tiles
+	TMap<uint64, FComponent> Cache;
+
+	int32 LastEnumerated = 0;
+	int32 LastCached = 0;
+};
@@ -0,0 +1,89 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "MinesweeperGameLogic.h"
+
+// What a recorded move did to its tile
+enum class EMinesweeperMoveKind : uint8
+{
+	Reveal,
+	Flag,
+	Chord
+};
+
+// One move of a recorded game
+struct FMinesweeperReplayMove
+{
+	int32 X = 0;
+	int32 Y = 0;
+	// Milliseconds since the game started
+	uint32 TimeMs = 0;
+	EMinesweeperMoveKind Kind = EMinesweeperMoveKind::Reveal;
+};
+
+// A game as its NewGame parameters plus the moves made on it.
+// Encoded as a length-prefixed record of varints: size, bombs, seed, topology, generator, then the moves with
+// coordinates and times delta-coded against the previous move and the move kind in the low two bits of the time delta.
+// Only the current format is read; records of older builds would not rebuild the same boards.
+// Graph topologies carry a table of their own and are not recorded.
+struct FMinesweeperReplay
+{
+	// File format version written by FMinesweeperReplayWriter
+	static constexpr uint8 FormatVersion = 5;
+
+	int32 Width = 0;
+	int32 Height = 0;
+	int32 Bombs = 0;
+	int32 Seed = 0;
+	EMinesweeperTopology Topology = EMinesweeperTopology::Square;
+	EMinesweeperGenerator Generator = EMinesweeperGenerator::Stream;
+	TArray<FMinesweeperReplayMove> Moves;
+
+	// Appends this game as one length-prefixed record
+	void Encode(TArray<uint8>& Out) const;
+
+	// Decodes a record payload (without its length prefix); false if the data is malformed or the board is not one the
+	// game could start: each side in [1, FMinesweeperGameLogic::MaxSide] and at least one safe tile
+	bool Decode(TArrayView<const uint8> Payload);
+
+	// Starts the recorded board on Game and re-drives every move; returns whether a bomb was hit
+	bool Play(FMinesweeperGameLogic& Game, TArray<int32>& ScratchChanged) const;
+};
+
+// Appends replay records to a single file
+class FMinesweeperReplayWriter
+{
+public:
+	// Opens Path for appending, writing the file header if the file is new; fails on a file of another format version
+	bool Open(const FString& Path);
+
+	void Append(const FMinesweeperReplay& Replay);
+
+	// Appends records already produced by FMinesweeperReplay::Encode
+	void AppendEncoded(TArrayView<const uint8> Records);
+
+	void Close();
+
+	bool IsOpen() const { return Ar.IsValid(); }
+
+private:
+	TUniquePtr<FArchive> Ar;
+	TArray<uint8> Scratch;
+};
+
+// Streams replay records out of a file one at a time, never loading the whole file
+class FMinesweeperReplayReader
+{
+public:
+	// Opens Path and checks the file header; only the current format version is accepted
+	bool Open(const FString& Path);
+
+	// Reads the next record; false at the end of the file or on a malformed record
+	bool Next(FMinesweeperReplay& Out);
+
+private:
+	TUniquePtr<FArchive> Ar;
+	TArray<uint8> Buffer;
+};
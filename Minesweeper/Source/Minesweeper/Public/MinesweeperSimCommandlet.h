@@ -0,0 +1,23 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "MinesweeperSimCommandlet.generated.h"
+
+// Plays many games headlessly on every core and reports win rate, moves, cascade sizes and throughput.
+// Usage: -run=MinesweeperSim [-Games=100000] [-Width=30] [-Height=16] [-Bombs=99] [-Policy=solver|random] [-Topology=square|hex|torus]
+//        [-Generator=stream|counter] [-Seed=1] [-ReplayOut=File]
+//        -run=MinesweeperSim -ReplayIn=File   (streams and re-plays a replay file)
+UCLASS()
+class UMinesweeperSimCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	UMinesweeperSimCommandlet();
+
+	// UCommandlet interface
+	virtual int32 Main(const FString& Params) override;
+};
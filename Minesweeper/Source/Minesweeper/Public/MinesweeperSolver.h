@@ -0,0 +1,120 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include <atomic>
+
+class FMinesweeperGameLogic;
+
+// Deduces safe tiles and certain mines from the revealed numbers of a game.
+// The frontier is updated from the tiles each Click reports as changed, and only constraints
+// touched since the last Solve are looked at again, so the cost of a move does not grow with the board.
+class FMinesweeperSolver
+{
+public:
+	// Binds to a game and clears every deduction; call after NewGame
+	void Reset(const FMinesweeperGameLogic& InGame);
+
+	// Feeds the tile indices a Click reported as changed
+	void OnTilesChanged(TArrayView<const int32> Changed);
+
+	// Runs single-tile and pair rules, then exhaustive search on small unresolved frontier components
+	void Solve();
+
+	// Flag another thread may set to stop Solve part way; the deductions made until then still hold. Null to clear.
+	void SetCancelFlag(const std::atomic<bool>* InCancel) { Cancel = InCancel; }
+
+	bool IsCancelled() const { return Cancel && Cancel->load(std::memory_order_relaxed); }
+
+	// Most recently deduced safe tile that is still hidden; false if the solver knows of none
+	bool PopSafeTile(int32& OutIndex);
+
+	bool IsKnownMine(int32 Index) const { return Knowledge.IsValidIndex(Index) && Knowledge[Index] == EKnowledge::Mine; }
+	bool IsKnownSafe(int32 Index) const { return Knowledge.IsValidIndex(Index) && Knowledge[Index] == EKnowledge::Safe; }
+
+	// Number of revealed tiles that still border undecided hidden tiles
+	int32 GetNumFrontierConstraints() const { return Constraints.Num(); }
+
+	// Components with more undecided tiles than this are left to the rules alone (max 32)
+	void SetMaxEnumerationTiles(int32 InMaxTiles) { MaxEnumerationTiles = FMath::Clamp(InMaxTiles, 0, 32); }
+
+private:
+	enum class EKnowledge : uint8
+	{
+		Unknown,
+		Safe,      // deduced safe, still hidden
+		Mine,      // deduced mine
+		Revealed
+	};
+
+	// A revealed number: exactly Mines of the Unknowns are bombs
+	struct FConstraint
+	{
+		TArray<int32, TInlineAllocator<8>> Unknowns;
+		int32 Mines = 0;
+		bool bDirty = false;
+	};
+
+	template <typename FuncType>
+	void ForEachNeighbour(int32 Index, FuncType&& Func) const;
+
+	// Builds the constraint for a newly revealed number tile
+	void AddConstraint(int32 Tile);
+
+	void MarkDirty(int32 ConstraintTile);
+
+	// Records a deduction and removes the tile from every constraint that contains it
+	void Resolve(int32 Tile, EKnowledge Result);
+
+	// All-safe / all-mines on a single constraint
+	bool ApplySingleRules(int32 ConstraintTile);
+
+	// Subset and difference rules between a constraint and each constraint it overlaps
+	bool ApplyPairRules(int32 ConstraintTile);
+
+	// Runs rules until the dirty worklist is empty
+	void Propagate();
+
+	// Constraints and undecided tiles connected to Seed through shared tiles, walked depth-first; marks them in Visited
+	void CollectComponent(int32 Seed, TArray<int32>& OutConstraints, TArray<int32>& OutTiles);
+
+	// Enumerates every consistent assignment of one component; resolves tiles with the same value in all of them
+	bool SolveComponent(const TArray<int32>& InConstraints, const TArray<int32>& InTiles);
+
+private:
+	const FMinesweeperGameLogic* Game = nullptr;
+	int32 Width = 0;
+	int32 Height = 0;
+
+	TArray<EKnowledge> Knowledge;
+
+	// Frontier, keyed by the revealed tile's index
+	TMap<int32, FConstraint> Constraints;
+
+	// Constraints waiting for the rules
+	TArray<int32> Dirty;
+
+	// Constraints changed since the last Solve; their components are the only ones searched
+	TSet<int32> Touched;
+
+	// Deduced-safe tiles in the order they were found; handed out from the back, newest first
+	TArray<int32> SafeQueue;
+
+	int32 MaxEnumerationTiles = 16;
+
+	// Scratch for Solve and the component search, kept between calls so a solve allocates nothing once warmed up
+	TSet<int32> Visited;
+	TSet<int32> ComponentTileSet;
+	TArray<int32> Seeds;
+	TArray<int32> Stack;
+	TArray<int32> ComponentConstraints;
+	TArray<int32> ComponentTiles;
+	TMap<int32, int32> LocalIndex;
+	TArray<int32> Target;
+	TArray<int32> Assigned;
+	TArray<int32> Remaining;
+	TArray<TArray<int32, TInlineAllocator<8>>> TileConstraints;
+
+	const std::atomic<bool>* Cancel = nullptr;
+};
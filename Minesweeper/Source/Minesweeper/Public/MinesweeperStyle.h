@@ -20,6 +20,17 @@ public:
 
 	static FName GetStyleSetName();
 
+	// Cells of the "Minesweeper.TileAtlas" brush, left to right; cells 1-8 hold the adjacency numbers
+	static constexpr int32 TileAtlasHidden = 0;
+	static constexpr int32 TileAtlasBomb = 9;
+	static constexpr int32 TileAtlasFlag = 10;
+	static constexpr int32 TileAtlasSolid = 11;
+	static constexpr int32 TileAtlasUsedCells = 12;
+	static constexpr int32 TileAtlasCells = 16;
+
+	// Copy of the tile atlas brush cropped to one cell; all cells share one texture, so tiles batch together
+	static FSlateBrush MakeTileAtlasCell(int32 Cell);
+
 private:
 
 	// Creates the actual style set
@@ -0,0 +1,17 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+// One byte per tile: a 0-8 neighbour count plus the bomb, revealed and flagged bits.
+// Bitfields keep the field syntax callers already use; assign through bool or an explicit uint8 cast.
+struct FMSPTile
+{
+	uint8 Adjacent : 4 = 0;
+	uint8 bIsBomb : 1 = 0;
+	uint8 bRevealed : 1 = 0;
+	uint8 bFlagged : 1 = 0;
+};
+
+static_assert(sizeof(FMSPTile) == 1, "FMSPTile is meant to pack into a single byte");
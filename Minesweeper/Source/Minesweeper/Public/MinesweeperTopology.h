@@ -0,0 +1,123 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+// How the tiles of a Width x Height board connect
+enum class EMinesweeperTopology : uint8
+{
+	// The classic 8-neighbour grid
+	Square,
+	// Rows of hexagons, odd rows shifted half a tile right; 6 neighbours
+	Hex,
+	// 8-neighbour grid whose edges wrap around to the opposite side
+	Torus,
+	// Any symmetric neighbour graph laid out on the grid, given by MakeGraph
+	Graph
+};
+
+// Neighbours of every tile of a board. Square and torus boards use the implicit 8-neighbour stencil (wrapped for the
+// torus): their table would cost more memory than the board itself, and square kernels are specialised on the stencil.
+// Hex and graph boards keep a table in CSR form: the neighbours of tile i (Y * Width + X) are
+// Neighbours[Offsets[i] .. Offsets[i + 1]). The table is immutable once built and shared by every copy of the
+// topology, so candidate boards, background tasks and the renderer all read the same one.
+class FMinesweeperTopology
+{
+public:
+	// Most neighbours a tile may have; a count has to fit the tile's adjacency bits and the atlas digits 1-8
+	static constexpr int32 MaxDegree = 8;
+
+	FMinesweeperTopology() = default;
+	explicit FMinesweeperTopology(EMinesweeperTopology InKind) : Kind(InKind) {}
+
+	// Builds a graph topology over a W x H layout from a ready-made CSR table (Offsets holds W * H + 1 entries).
+	// Fails, leaving Out untouched, unless every edge is listed from both ends, there are no self-loops or
+	// repeated neighbours, and no tile has more than MaxDegree neighbours.
+	static bool MakeGraph(int32 W, int32 H, TArray<int32> InOffsets, TArray<int32> InNeighbours, FMinesweeperTopology& Out);
+
+	// Sizes the topology for a W x H board and fills its table if it has one. A graph keeps its own size and table.
+	void Build(int32 W, int32 H);
+
+	// Calls Func(NeighbourIndex) for every neighbour of Index
+	template <typename FuncType>
+	void ForEachNeighbour(int32 Index, FuncType&& Func) const
+	{
+		const int32 X = Index % Width;
+		const int32 Y = Index / Width;
+		if (Kind == EMinesweeperTopology::Square)
+		{
+			for (int32 ny = FMath::Max(0, Y - 1); ny <= FMath::Min(Height - 1, Y + 1); ++ny)
+			{
+				for (int32 nx = FMath::Max(0, X - 1); nx <= FMath::Min(Width - 1, X + 1); ++nx)
+				{
+					if (nx != X || ny != Y) Func(ny * Width + nx);
+				}
+			}
+			return;
+		}
+
+		if (Kind == EMinesweeperTopology::Torus)
+		{
+			int32 Cols[3], Rows[3];
+			const int32 NumCols = WrapAround(X, Width, Cols);
+			const int32 NumRows = WrapAround(Y, Height, Rows);
+			for (int32 r = 0; r < NumRows; ++r)
+			{
+				for (int32 c = 0; c < NumCols; ++c)
+				{
+					if (r != 0 || c != 0) Func(Rows[r] * Width + Cols[c]);
+				}
+			}
+			return;
+		}
+
+		const TArray<int32>& Offsets = Table->Offsets;
+		const TArray<int32>& Neighbours = Table->Neighbours;
+		for (int32 n = Offsets[Index]; n < Offsets[Index + 1]; ++n)
+		{
+			Func(Neighbours[n]);
+		}
+	}
+
+	// True for the kinds that walk a neighbour table rather than a stencil
+	bool HasTable() const { return Kind == EMinesweeperTopology::Hex || Kind == EMinesweeperTopology::Graph; }
+
+	// Graphs bring their own size, which NewGame takes over
+	bool HasFixedSize() const { return Kind == EMinesweeperTopology::Graph; }
+
+	EMinesweeperTopology GetKind() const { return Kind; }
+	int32 GetWidth() const { return Width; }
+	int32 GetHeight() const { return Height; }
+
+	// Saves or loads the kind, plus the table for a graph; built-in kinds are rebuilt by Build instead.
+	// A malformed graph leaves the archive in error.
+	void Serialize(FArchive& Ar);
+
+private:
+	struct FTable
+	{
+		TArray<int32> Offsets;
+		TArray<int32> Neighbours;
+	};
+
+	// V first, then its distinct wrapped neighbours along an axis of Size tiles; returns how many were written
+	static int32 WrapAround(int32 V, int32 Size, int32 Out[3])
+	{
+		int32 Num = 0;
+		Out[Num++] = V;
+		if (Size > 1) Out[Num++] = V + 1 < Size ? V + 1 : 0;
+		if (Size > 2) Out[Num++] = V > 0 ? V - 1 : Size - 1;
+		return Num;
+	}
+
+	// Fills a new table from a per-tile neighbour function for the built-in kinds
+	template <typename FuncType>
+	void BuildTable(FuncType&& TileNeighbours);
+
+private:
+	EMinesweeperTopology Kind = EMinesweeperTopology::Square;
+	int32 Width = 0;
+	int32 Height = 0;
+	TSharedPtr<const FTable, ESPMode::ThreadSafe> Table;
+};
@@ -0,0 +1,128 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Widgets/SLeafWidget.h"
+#include "Widgets/DeclarativeSyntaxSupport.h"
+#include "Styling/SlateBrush.h"
+#include "MinesweeperStyle.h"
+
+class FMinesweeperGameLogic;
+class FMinesweeperChunkedBoard;
+
+DECLARE_DELEGATE_TwoParams(FOnMinesweeperTileClicked, int32 /*X*/, int32 /*Y*/);
+DECLARE_DELEGATE_OneParam(FOnMinesweeperViewChanged, const FIntRect& /*VisibleTiles*/);
+
+// Leaf widget that paints the minesweeper grid itself, so the widget count stays constant regardless of board size.
+// Acts as a viewport onto the board: only tiles inside it are painted, the middle mouse button pans and the wheel zooms.
+class SMinesweeperBoard : public SLeafWidget
+{
+public:
+	SLATE_BEGIN_ARGS(SMinesweeperBoard)
+		: _Game(nullptr)
+		, _TileSize(24.f)
+		, _TilePadding(1.f)
+	{}
+		// Game whose grid is drawn; owned by the parent widget
+		SLATE_ARGUMENT(const FMinesweeperGameLogic*, Game)
+		// Endless board drawn instead of Game while SetEndless is on; owned by the parent widget
+		SLATE_ARGUMENT(const FMinesweeperChunkedBoard*, Endless)
+		// Size of one tile's square content, in slate units
+		SLATE_ARGUMENT(float, TileSize)
+		// Gap kept on each side of a tile
+		SLATE_ARGUMENT(float, TilePadding)
+		// Fired with the tile coordinates when a tile is left-clicked
+		SLATE_EVENT(FOnMinesweeperTileClicked, OnTileClicked)
+		// Fired with the tile coordinates when a tile is right-clicked
+		SLATE_EVENT(FOnMinesweeperTileClicked, OnTileFlagged)
+		// Fired before painting whenever the endless board's visible tiles [Min, Max) change, so the owner can page them in
+		SLATE_EVENT(FOnMinesweeperViewChanged, OnViewChanged)
+	SLATE_END_ARGS()
+
+	void Construct(const FArguments& InArgs);
+
+	// Board dimensions changed (new game): re-layout, scroll back to the top left and repaint
+	void RefreshBoard();
+
+	// Some tiles changed state: repaint only, layout is unchanged, and only if one of them was in view at the last paint
+	void RefreshTiles(TArrayView<const int32> Changed);
+	void RefreshTiles(TArrayView<const FIntPoint> Changed);
+
+	// What the view shows changed without a list of tiles, e.g. chunks paged in: repaint it
+	void RefreshView();
+
+	// Draws the endless board instead of the game, or the game again; follow with RefreshBoard
+	void SetEndless(bool bInEndless);
+
+	// Mine chance per tile (Y * Width + X) to tint hidden tiles with, negative where unknown; empty turns the overlay off
+	void SetProbabilities(TArray<float>&& InProbabilities);
+
+	// SWidget interface
+	virtual int32 OnPaint(const FPaintArgs& Args, const FGeometry& AllottedGeometry, const FSlateRect& MyCullingRect, FSlateWindowElementList& OutDrawElements, int32 LayerId, const FWidgetStyle& InWidgetStyle, bool bParentEnabled) const override;
+	virtual FReply OnMouseButtonDown(const FGeometry& MyGeometry, const FPointerEvent& MouseEvent) override;
+	virtual FReply OnMouseButtonUp(const FGeometry& MyGeometry, const FPointerEvent& MouseEvent) override;
+	virtual FReply OnMouseMove(const FGeometry& MyGeometry, const FPointerEvent& MouseEvent) override;
+	virtual FReply OnMouseWheel(const FGeometry& MyGeometry, const FPointerEvent& MouseEvent) override;
+	virtual void Tick(const FGeometry& AllottedGeometry, const double InCurrentTime, const float InDeltaTime) override;
+
+protected:
+	virtual FVector2D ComputeDesiredSize(float LayoutScaleMultiplier) const override;
+
+private:
+	// Distance between the origins of two neighbouring tiles, in board units (slate units at zoom 1)
+	float GetPitch() const { return TileSize + TilePadding * 2.f; }
+
+	// Horizontal offset of row Y in board units: hex boards shift odd rows half a tile right
+	float GetRowShift(int32 Y) const;
+
+	// Whole board extent in board units; unbounded boards have none
+	FVector2D GetBoardExtent() const;
+
+	bool IsEndless() const { return bEndless && Endless; }
+
+	// Tiles [Min, Max) under a viewport of the given local size, cut to the board when it has edges
+	FIntRect GetVisibleTiles(const FVector2D& ViewSize) const;
+
+	// Whether a tile lies in the range drawn by the last paint
+	bool IsTilePainted(const FIntPoint& Tile) const;
+
+	// Maps a local position to tile coordinates; false if outside the grid or on the gap between tiles
+	bool TileFromLocalPosition(const FVector2D& LocalPos, int32& OutX, int32& OutY) const;
+
+	// Keeps the view inside the board for a viewport of the given local size; an endless view only inside the world limits
+	void ClampView(const FVector2D& ViewSize);
+
+private:
+	const FMinesweeperGameLogic* Game = nullptr;
+	const FMinesweeperChunkedBoard* Endless = nullptr;
+	bool bEndless = false;
+	float TileSize = 24.f;
+	float TilePadding = 1.f;
+	FOnMinesweeperTileClicked OnTileClicked;
+	FOnMinesweeperTileClicked OnTileFlagged;
+	FOnMinesweeperViewChanged OnViewChanged;
+
+	// Endless tiles last reported through OnViewChanged
+	FIntRect ReportedView;
+
+	// Tiles [Min, Max) drawn by the last paint; a pan or zoom repaints and moves it, so changes outside it can wait
+	mutable FIntRect PaintedTiles;
+
+	// One brush per tile atlas cell, all sharing the atlas texture
+	FSlateBrush AtlasCells[FMinesweeperStyle::TileAtlasUsedCells];
+
+	// Heatmap overlay, as last handed over by the owner; ignored unless it matches the board size
+	TArray<float> Probabilities;
+
+	// Time of the last tile click not yet painted, for the click-to-repaint stat
+	mutable double PendingClickTime = 0.0;
+
+	// Board-space point shown at the viewport's top left, and local units per board unit
+	FVector2D ViewOffset = FVector2D::ZeroVector;
+	float Zoom = 1.f;
+	bool bPanning = false;
+
+	static constexpr float MinZoom = 0.1f;
+	static constexpr float MaxZoom = 4.f;
+};
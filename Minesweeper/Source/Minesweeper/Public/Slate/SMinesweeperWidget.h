@@ -6,8 +6,12 @@
 #include "Widgets/SCompoundWidget.h"
 #include "Widgets/DeclarativeSyntaxSupport.h"
 #include "MinesweeperGameLogic.h"
+#include "MinesweeperChunkedBoard.h"
+#include "MinesweeperReplay.h"
+#include "MinesweeperProbability.h"
 
 class STextBlock; // + added
+class SMinesweeperBoard;
 
 class SMinesweeperWidget : public SCompoundWidget
 {
@@ -17,12 +21,50 @@ public:
 
 	void Construct(const FArguments& InArgs);
 
+	// Saves the game in progress so the next tab can pick it up
+	virtual ~SMinesweeperWidget();
+
 private:
 	FReply OnNewGameClicked();
+
+	// Starts an endless game at the density of the width, height and bombs set in the header
+	void StartEndless();
+
+	// Pages the endless board's chunks to what the view shows
+	void OnBoardViewChanged(const FIntRect& VisibleTiles);
+
+	// Applies the queued input to the endless board
+	void ApplyEndlessInput();
+
+	// Game over on whichever board is being played
+	bool IsPlayOver() const { return bEndlessGame ? Endless.IsGameOver() : Game.IsGameOver(); }
+
+	// Background generation of the next board
+	void StartGeneration();
+	EActiveTimerReturnType PollGeneration(double InCurrentTime, float InDeltaTime);
+	bool IsGenerating() const { return Pending.IsValid(); }
+	FReply OnUndoClicked();
+	FReply OnRedoClicked();
 	void RebuildGrid();
 
-	// Click handler per tile
-	FReply OnTileClicked(int32 X, int32 Y);
+	// Repaints the board after the given tile indices changed
+	void UpdateTiles(const TArray<int32>& Changed);
+
+	// Click handlers, bound to the board; they only queue the input for the next frame
+	void OnTileClicked(int32 X, int32 Y);
+	void OnTileFlagged(int32 X, int32 Y);
+
+	// Applies the input queued since the last frame as one board update
+	void QueueInput(int32 X, int32 Y, bool bFlag);
+	EActiveTimerReturnType ApplyQueuedInput(double InCurrentTime, float InDeltaTime);
+
+	// Reports a won or lost game after a move
+	void OnMoveFinished(bool bHitBomb);
+
+	// Background mine probabilities for the overlay: asks for the current board, or clears the overlay when off or over
+	void RequestProbabilities();
+	void LaunchProbabilities();
+	EActiveTimerReturnType PollProbabilities(double InCurrentTime, float InDeltaTime);
 
 	// Helper function declarations
 	TSharedRef<SWidget> BuildHeaderBar();
@@ -31,18 +73,108 @@ private:
 	// Warning logic
 	void UpdateBombWarning();
 
+	// Replay recording of the current game
+	void BeginReplay();
+	void RecordMove(int32 X, int32 Y, EMinesweeperMoveKind Kind);
+	void SaveReplay();
+
+	// In-progress game persistence across tab close/open
+	bool LoadGame();
+	void SaveGame();
+
 private:
 	// Configure
 	int32 GridW = 10;
 	int32 GridH = 10;
 	int32 Bombs = 10;
+	bool bNoGuess = false;
+	bool bEndlessMode = false;
+	bool bShowProbabilities = false;
+	EMinesweeperTopology Topology = EMinesweeperTopology::Square;
 
 	// Logic
 	FMinesweeperGameLogic Game;
 
+	// Endless board, played instead of Game while bEndlessGame is set; it is not saved, replayed or undone
+	FMinesweeperChunkedBoard Endless;
+	bool bEndlessGame = false;
+	// Endless tiles in view, as last reported by the board
+	FIntRect EndlessView;
+	// Scratch for endless moves: the last move's tiles and the frame's
+	TArray<FIntPoint> EndlessChanged;
+	TArray<FIntPoint> EndlessFrameChanged;
+
 	// UI references
-	TSharedPtr<class SGridPanel> GridPanel;
+	TSharedPtr<SMinesweeperBoard> Board;
+
+	// Scratch list of tiles changed by the last click (reused between clicks)
+	TArray<int32> ChangedTiles;
+
+	// Board input waiting for the next frame, in arrival order
+	struct FQueuedInput
+	{
+		FIntPoint Tile;
+		bool bFlag = false;
+	};
+	TArray<FQueuedInput> QueuedInput;
+	TSharedPtr<FActiveTimerHandle> InputTimer;
+
+	// Scratch for applying a frame's input: a run of reveals, and every tile the frame changed
+	TArray<FIntPoint> RevealBatch;
+	TArray<int32> FrameChangedTiles;
+
+	// Current game's parameters and moves, appended to the replay file when it ends
+	FMinesweeperReplay Replay;
+	double ReplayStartTime = 0.0;
+	bool bRecordingReplay = false;
 
 	// Warning text (yellow) when bombs > 20%
 	TSharedPtr<STextBlock> BombWarningText;
+
+	// Attempts and time of the last no-guess generation, or progress of the running one
+	TSharedPtr<STextBlock> GenerationText;
+
+	// A board being built on a task; only the task writes it until bDone is set
+	struct FPendingGeneration
+	{
+		FMinesweeperGameLogic Game;
+		FMinesweeperGenerationControl Control;
+		FMinesweeperNoGuessStats Stats;
+		// Centre tile a no-guess board is solved and opened from; plain boards leave the first click to the player
+		int32 StartX = 0;
+		int32 StartY = 0;
+		bool bNoGuess = false;
+		std::atomic<bool> bDone { false };
+	};
+	TSharedPtr<FPendingGeneration, ESPMode::ThreadSafe> Pending;
+	TSharedPtr<FActiveTimerHandle> GenerationTimer;
+	double GenerationStartTime = 0.0;
+
+	// One probability pass on a task; only the task writes it until bDone is set
+	struct FPendingProbabilities
+	{
+		// The whole visible board when the calculator needs all of it, else the tiles changed since the last pass
+		TArray<uint8> Visible;
+		TArray<int32> ChangedTiles;
+		TArray<uint8> ChangedValues;
+		// Set for the first pass of a game, which rebinds the calculator (and drops its cache)
+		TOptional<FMinesweeperTopology> NewTopology;
+		int32 Bombs = 0;
+		TArray<float> Result;
+		bool bComplete = false;
+		std::atomic<bool> bCancel { false };
+		std::atomic<bool> bDone { false };
+	};
+	// Shared by the passes, one at a time, so each only enumerates the frontier components its move changed
+	TSharedPtr<FMinesweeperProbability, ESPMode::ThreadSafe> Probability;
+	TSharedPtr<FPendingProbabilities, ESPMode::ThreadSafe> PendingProbabilities;
+	TSharedPtr<FActiveTimerHandle> ProbabilityTimer;
+	// The board moved on while a pass was running, so another is due when it ends
+	bool bProbabilitiesDirty = false;
+	// The game was replaced since the calculator was last bound
+	bool bProbabilityGameChanged = true;
+	// Tiles changed since the last pass was launched; only they are snapshotted for the next one
+	TArray<int32> ProbabilityChangedTiles;
+	// Changes went untracked (overlay off, game over), so the next pass sends the whole board
+	bool bProbabilityResync = false;
 };